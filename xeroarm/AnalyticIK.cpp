@@ -0,0 +1,191 @@
+#include "AnalyticIK.h"
+#include "RobotArm.h"
+#include "MathUtils.h"
+#include <cmath>
+#include <limits>
+
+AnalyticIK::AnalyticIK(const RobotArm& arm) : InverseKinematics(arm)
+{
+}
+
+void AnalyticIK::solveTwoLink(const Translation2d& pt, double l1, double l2, QVector<QVector<double>>& results) const
+{
+	double x = pt.getX();
+	double y = pt.getY();
+
+	//
+	// Law of cosines gives the elbow angle, the sign of the elbow angle picks the branch
+	//
+	double c2 = (x * x + y * y - l1 * l1 - l2 * l2) / (2.0 * l1 * l2);
+	if (c2 > 1.0 + MathUtils::kEpsilon || c2 < -1.0 - MathUtils::kEpsilon)
+		return;
+
+	c2 = std::max(-1.0, std::min(1.0, c2));
+	double elbow = std::acos(c2);
+
+	for (double a2 : { elbow, -elbow }) {
+		double a1 = std::atan2(y, x) - std::atan2(l2 * std::sin(a2), l1 + l2 * std::cos(a2));
+
+		QVector<double> angles;
+		angles.push_back(MathUtils::boundDegrees(MathUtils::radiansToDegrees(a1)));
+		angles.push_back(MathUtils::boundDegrees(MathUtils::radiansToDegrees(a2)));
+		results.push_back(angles);
+
+		//
+		// Fully stretched or fully folded, both branches are the same
+		//
+		if (elbow == 0.0 || elbow == MathUtils::kPI)
+			break;
+	}
+}
+
+bool AnalyticIK::wristHeading(const Translation2d& pt, double preferred, double& heading) const
+{
+	//
+	// The wrist sits at pt - L3 * (cos(h), sin(h)) and must be within the annulus the first two
+	// links can reach.  With d the distance to the target and a its direction this means
+	//
+	//    rmin^2 <= d^2 + L3^2 - 2 * L3 * d * cos(h - a) <= rmax^2
+	//
+	// which bounds cos(h - a).  Pick the reachable heading closest to the preferred one.
+	//
+	double l1 = arm_.at(0).length();
+	double l2 = arm_.at(1).length();
+	double l3 = arm_.at(2).length();
+	double rmin = std::fabs(l1 - l2);
+	double rmax = l1 + l2;
+
+	double d = pt.normalize();
+	if (d < MathUtils::kEpsilon || l3 < MathUtils::kEpsilon) {
+		heading = preferred;
+		return d + l3 <= rmax + MathUtils::kEpsilon && d + l3 >= rmin - MathUtils::kEpsilon;
+	}
+
+	double a = MathUtils::radiansToDegrees(std::atan2(pt.getY(), pt.getX()));
+	double lo = (d * d + l3 * l3 - rmax * rmax) / (2.0 * l3 * d);
+	double hi = (d * d + l3 * l3 - rmin * rmin) / (2.0 * l3 * d);
+
+	if (lo > 1.0 + MathUtils::kEpsilon || hi < -1.0 - MathUtils::kEpsilon)
+		return false;
+
+	//
+	// The reachable offsets from a are [mindelta, maxdelta] and its mirror image
+	//
+	double mindelta = MathUtils::radiansToDegrees(std::acos(std::max(-1.0, std::min(1.0, hi))));
+	double maxdelta = MathUtils::radiansToDegrees(std::acos(std::max(-1.0, std::min(1.0, lo))));
+
+	double delta = MathUtils::boundDegrees(preferred - a);
+	double mag = std::max(mindelta, std::min(maxdelta, std::fabs(delta)));
+	heading = a + (delta < 0.0 ? -mag : mag);
+
+	return true;
+}
+
+QVector<QVector<double>> AnalyticIK::solutions(const Pose2d& pose) const
+{
+	QVector<QVector<double>> results;
+
+	if (!supports(arm_.count()))
+		return results;
+
+	Translation2d local = pose.getTranslation().translateBy(arm_.pos().inverse());
+	double l1 = arm_.at(0).length();
+	double l2 = arm_.at(1).length();
+
+	if (arm_.count() == 2) {
+		solveTwoLink(local, l1, l2, results);
+	}
+	else {
+		double heading = pose.getRotation().toDegrees();
+		Translation2d wrist = local - Translation2d(pose.getRotation(), arm_.at(2).length());
+
+		solveTwoLink(wrist, l1, l2, results);
+		for (QVector<double>& angles : results) {
+			angles.push_back(MathUtils::boundDegrees(heading - angles[0] - angles[1]));
+		}
+	}
+
+	QVector<QVector<double>> ret;
+	for (const QVector<double>& angles : results) {
+		if (arm_.withinLimits(angles))
+			ret.push_back(angles);
+	}
+
+	return ret;
+}
+
+QVector<double> AnalyticIK::closest(const QVector<QVector<double>>& solutions, const QVector<double>& seed) const
+{
+	QVector<double> ret;
+	double best = std::numeric_limits<double>::max();
+
+	for (const QVector<double>& angles : solutions) {
+		double dist = 0.0;
+		for (int i = 0; i < angles.count(); i++) {
+			double delta = MathUtils::boundDegrees(angles[i] - seed[i]);
+			dist += delta * delta;
+		}
+
+		if (dist < best) {
+			best = dist;
+			ret = angles;
+		}
+	}
+
+	return ret;
+}
+
+QVector<double> AnalyticIK::inverseKinematics(const Translation2d& pt) const
+{
+	QVector<double> angles;
+	for (int i = 0; i < arm_.count(); i++) {
+		angles.push_back(arm_.at(i).initialAngle());
+	}
+
+	return inverseKinematics(pt, angles);
+}
+
+bool AnalyticIK::supportsArm() const
+{
+	return supports(arm_.count());
+}
+
+QVector<double> AnalyticIK::inverseKinematics(const Translation2d& pt, const QVector<double>& seed) const
+{
+	if (seed.count() != arm_.count())
+		return inverseKinematics(pt);
+
+	if (!supports(arm_.count()))
+		return QVector<double>();
+
+	Pose2d pose(pt);
+	if (arm_.count() == 3) {
+		//
+		// Only the position was given, so keep the last link as close as possible to the
+		// heading it has in the seed
+		//
+		double heading;
+		if (!wristHeading(pt.translateBy(arm_.pos().inverse()), seed[0] + seed[1] + seed[2], heading))
+			return QVector<double>();
+
+		pose = Pose2d(pt, Rotation2d::fromDegrees(heading));
+
+		//
+		// Both elbow branches at that heading may be outside the joint limits.  Try headings
+		// further and further from it, either way, and take the first that has a solution
+		// within the limits.
+		//
+		QVector<QVector<double>> found = solutions(pose);
+		for (double offset = headingStep; found.isEmpty() && offset <= 180.0; offset += headingStep) {
+			for (double h : { heading + offset, heading - offset }) {
+				found = solutions(Pose2d(pt, Rotation2d::fromDegrees(h)));
+				if (!found.isEmpty())
+					break;
+			}
+		}
+
+		return closest(found, seed);
+	}
+
+	return closest(solutions(pose), seed);
+}
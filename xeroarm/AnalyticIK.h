@@ -0,0 +1,41 @@
+#pragma once
+
+#include "InverseKinematics.h"
+#include "Pose2d.h"
+#include <QtCore/QVector>
+
+class RobotArm;
+
+//
+// Closed form inverse kinematics for planar arms with two or three joints.  Two joint arms are
+// solved with the law of cosines.  Three joint arms need the heading of the last link to pin
+// down the wrist, after which the first two joints are a two joint problem.  Either way there
+// are at most two solutions, elbow up and elbow down.
+//
+class AnalyticIK : public InverseKinematics
+{
+public:
+	AnalyticIK(const RobotArm& arm);
+
+	static bool supports(int count) {
+		return count == 2 || count == 3;
+	}
+
+	bool supportsArm() const;
+
+	QVector<double> inverseKinematics(const Translation2d& pt) const;
+	QVector<double> inverseKinematics(const Translation2d& pt, const QVector<double>& seed) const;
+	QVector<QVector<double>> solutions(const Pose2d& pose) const;
+
+private:
+	void solveTwoLink(const Translation2d& pt, double l1, double l2, QVector<QVector<double>>& results) const;
+	bool wristHeading(const Translation2d& pt, double preferred, double& heading) const;
+	QVector<double> closest(const QVector<QVector<double>>& solutions, const QVector<double>& seed) const;
+
+private:
+	//
+	// How far apart, in degrees, the other wrist headings are that a three joint arm tries
+	// when neither elbow branch at the preferred heading is within the joint limits
+	//
+	static constexpr const double headingStep = 2.0;
+};
@@ -0,0 +1,180 @@
+#include "AnnealingIK.h"
+#include "RobotArm.h"
+#include "DampedLeastSquaresIK.h"
+#include "FixedKinematicsIK.h"
+#include "JointLimitIK.h"
+#include "ThreadPool.h"
+#include "MathUtils.h"
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <mutex>
+
+//
+// State shared by the chains searching for one target
+//
+struct AnnealingIK::Search
+{
+	Translation2d target;
+	QVector<double> seed;
+	std::chrono::steady_clock::time_point deadline;
+
+	std::atomic<bool> done;
+	std::atomic<int> iterations;
+
+	std::mutex lock;
+	QVector<double> solution;
+};
+
+AnnealingIK::AnnealingIK(const RobotArm& arm) : InverseKinematics(arm)
+{
+	dls_ = new SpecializedIK(arm, new DampedLeastSquaresIK(arm), true);
+	limits_ = new JointLimitIK(arm);
+}
+
+AnnealingIK::~AnnealingIK()
+{
+	delete dls_;
+	delete limits_;
+}
+
+const InverseKinematics* AnnealingIK::localSolver() const
+{
+	if (arm_.hasJointLimits())
+		return limits_;
+
+	return dls_;
+}
+
+bool AnnealingIK::reachable(const Translation2d& pt) const
+{
+	//
+	// Nothing outside the annulus swept by the arm can be reached no matter how long
+	// the search runs
+	//
+	double longest = 0.0;
+	for (const JointDataModel& joint : arm_.joints()) {
+		longest = std::max(longest, joint.length());
+	}
+
+	double total = arm_.maxArmLength();
+	double dist = pt.distance(arm_.pos());
+
+	return dist <= total + arrivedThreshold && dist >= 2.0 * longest - total - arrivedThreshold;
+}
+
+QVector<double> AnnealingIK::initialAngles() const
+{
+	QVector<double> ret(arm_.count());
+	for (int i = 0; i < arm_.count(); i++) {
+		ret[i] = arm_.at(i).initialAngle();
+	}
+
+	return ret;
+}
+
+QVector<double> AnnealingIK::perturb(const QVector<double>& angles, double temperature, std::mt19937& rng) const
+{
+	std::normal_distribution<double> dist(0.0, temperature);
+	QVector<double> ret(angles.count());
+
+	for (int i = 0; i < angles.count(); i++) {
+		const JointDataModel& joint = arm_.at(i);
+		double angle = MathUtils::boundDegrees(angles[i] + dist(rng));
+		ret[i] = std::max(-joint.cwConstraint(), std::min(joint.ccwConstraint(), angle));
+	}
+
+	return ret;
+}
+
+void AnnealingIK::runChain(Search& search, int chain) const
+{
+	const InverseKinematics* local = localSolver();
+
+	//
+	// Seed each chain from the target. The chain's starting point and random moves are
+	// fixed for a target, but how far it gets depends on when the wall time budget runs
+	// out or another chain finishes, so two searches for the same target can return
+	// different solutions
+	//
+	std::seed_seq seq{ chain, static_cast<int>(search.target.getX() * 1000.0), static_cast<int>(search.target.getY() * 1000.0) };
+	std::mt19937 rng(seq);
+	std::uniform_real_distribution<double> uniform(0.0, 1.0);
+
+	double temperature = maxTemperature * std::pow(0.5, chain % 4);
+	double scale = arm_.maxArmLength();
+
+	QVector<double> current = search.seed;
+	double energy = std::numeric_limits<double>::infinity();
+
+	for (int round = 0; round < maxRounds; round++) {
+		if (search.done || std::chrono::steady_clock::now() > search.deadline)
+			return;
+
+		QVector<double> start = (round == 0 && chain == 0) ? current : perturb(current, temperature, rng);
+
+		IKStats stats;
+		QVector<double> angles = local->inverseKinematics(search.target, start, stats);
+		search.iterations += stats.iterations;
+
+		if (!angles.isEmpty()) {
+			std::lock_guard guard(search.lock);
+			if (!search.done) {
+				search.solution = angles;
+				search.done = true;
+			}
+			return;
+		}
+
+		//
+		// Metropolis, always move to a start that gets closer and sometimes to one that does
+		// not, less often as the chain cools
+		//
+		double delta = stats.error - energy;
+		if (delta < 0.0 || uniform(rng) < std::exp(-delta / (scale * temperature / maxTemperature))) {
+			current = start;
+			energy = stats.error;
+		}
+
+		temperature *= cooling;
+	}
+}
+
+QVector<double> AnnealingIK::inverseKinematics(const Translation2d& pt) const
+{
+	IKStats stats;
+	return inverseKinematics(pt, initialAngles(), stats);
+}
+
+QVector<double> AnnealingIK::inverseKinematics(const Translation2d& pt, const QVector<double>& seed) const
+{
+	IKStats stats;
+	return inverseKinematics(pt, seed, stats);
+}
+
+QVector<double> AnnealingIK::inverseKinematics(const Translation2d& pt, const QVector<double>& seed, IKStats& stats) const
+{
+	stats = IKStats();
+
+	if (arm_.count() == 0 || !reachable(pt))
+		return QVector<double>();
+
+	Search search;
+	search.target = pt;
+	search.seed = (seed.count() == arm_.count()) ? seed : initialAngles();
+	search.deadline = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(maxWallTime));
+	search.done = false;
+	search.iterations = 0;
+
+	int chains = std::max(minChains, std::min(maxChains, ThreadPool::global().threadCount()));
+	ThreadPool::global().parallelFor(chains, [this, &search](int chain) {
+		runChain(search, chain);
+	});
+
+	stats.iterations = search.iterations;
+	stats.converged = search.done;
+	if (stats.converged)
+		stats.error = arm_.forwardKinematics(search.solution).distance(pt);
+
+	return search.solution;
+}
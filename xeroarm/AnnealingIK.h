@@ -0,0 +1,59 @@
+#pragma once
+
+#include "InverseKinematics.h"
+#include <QtCore/QVector>
+#include <atomic>
+#include <random>
+
+class RobotArm;
+
+//
+// Global inverse kinematics for targets the local solvers give up on, usually ones near the
+// edge of the workspace or behind a joint limit.  A number of chains run in parallel on the
+// thread pool.  Each chain repeatedly perturbs a starting pose, runs a short local solve from
+// it, and keeps the new start with the Metropolis rule at a temperature that cools each round.
+// The chains start at different temperatures, so some search widely while others stay near the
+// seed.  The first chain to reach the target stops the rest, and the whole search gives up after
+// a fixed number of rounds or a fixed wall clock time, whichever comes first.
+//
+class AnnealingIK : public InverseKinematics
+{
+public:
+	AnnealingIK(const RobotArm& arm);
+	virtual ~AnnealingIK();
+
+	QVector<double> inverseKinematics(const Translation2d& pt) const;
+	QVector<double> inverseKinematics(const Translation2d& pt, const QVector<double>& seed) const;
+	QVector<double> inverseKinematics(const Translation2d& pt, const QVector<double>& seed, IKStats& stats) const;
+
+private:
+	struct Search;
+
+	const InverseKinematics* localSolver() const;
+	bool reachable(const Translation2d& pt) const;
+	QVector<double> initialAngles() const;
+	QVector<double> perturb(const QVector<double>& angles, double temperature, std::mt19937& rng) const;
+	void runChain(Search& search, int chain) const;
+
+private:
+	static constexpr const int minChains = 4;
+	static constexpr const int maxChains = 16;
+	static constexpr const int maxRounds = 25;
+	static constexpr const double maxWallTime = 0.1;
+
+	//
+	// Temperatures are the standard deviation of the perturbation in degrees
+	//
+	static constexpr const double maxTemperature = 180.0;
+	static constexpr const double cooling = 0.85;
+
+	static constexpr const double arrivedThreshold = 0.1;
+
+private:
+	//
+	// The local solvers, damped least squares when the joints are free and the joint limit
+	// solver when they are not
+	//
+	InverseKinematics* dls_;
+	InverseKinematics* limits_;
+};
@@ -1,8 +1,10 @@
 #include "ArmDataModel.h"
 #include "JsonFileKeywords.h"
 #include "ArmMotionProfileGenerator.h"
+#include "IKLookupTable.h"
 #include <QtCore/QFile>
 #include <QtCore/QTextStream>
+#include <algorithm>
 
 ArmDataModel::ArmDataModel()
 {
@@ -15,13 +17,16 @@ ArmDataModel::ArmDataModel()
 	dirty_ = false;
 
 	running_ = true;
-	generate_ = std::thread(&ArmDataModel::threadFunction, this);
+	active_ = 0;
+	epoch_ = 0;
 }
 
 ArmDataModel::~ArmDataModel()
 {
 	running_ = false;
-	generate_.join();
+
+	std::lock_guard guard(queue_lock_);
+	queue_.clear();
 }
 
 void ArmDataModel::writeTrajectory(std::shared_ptr<ArmMotionProfile> profile, const QString& filename)
@@ -98,48 +103,135 @@ void ArmDataModel::generateTrajectories()
 	}
 
 	if (ok) {
-		std::lock_guard guard(queue_lock_);
-		queue_.clear();
-		for (auto path : paths_.values()) {
-			queue_.push_back(path);
+		int jobs;
+
+		{
+			std::lock_guard guard(queue_lock_);
+			queue_.clear();
+			epoch_++;
+			snapshot_ = std::make_shared<RobotArm>(arm_);
+
+			auto now = std::chrono::steady_clock::now();
+			for (auto path : paths_.values()) {
+				queue_.push_back({ path, std::make_shared<ArmPath>(*path), now });
+			}
+
+			//
+			// Jobs already running pick up the new queue, so only start the ones missing
+			//
+			jobs = std::max(0, std::min(static_cast<int>(queue_.count()), pool_.threadCount()) - active_);
+			active_ += jobs;
+		}
+
+		for (int i = 0; i < jobs; i++) {
+			pool_.post([this]() { generateFunction(); });
 		}
 	}
 }
 
-void ArmDataModel::threadFunction()
+void ArmDataModel::setSelectedPath(std::shared_ptr<ArmPath> path)
+{
+	std::lock_guard guard(queue_lock_);
+	selected_ = path;
+}
+
+void ArmDataModel::generateFunction()
 {
 	while (running_)
 	{
 		std::shared_ptr<ArmPath> path;
+		std::shared_ptr<ArmPath> snapshot;
+		std::shared_ptr<RobotArm> arm;
+		std::chrono::steady_clock::time_point queued;
+		uint64_t epoch = 0;
+		bool idle = false;
+
 		{
 			std::lock_guard guard(queue_lock_);
-			if (!queue_.isEmpty()) {
-				path = queue_.front();
-				queue_.pop_front();
+			if (queue_.isEmpty()) {
+				active_--;
+				idle = (active_ == 0);
+			}
+			else {
+				//
+				// The selected path first, the rest in the order they were queued
+				//
+				int which = 0;
+				for (int i = 0; i < queue_.count(); i++) {
+					if (queue_[i].path == selected_) {
+						which = i;
+						break;
+					}
+				}
+
+				path = queue_[which].path;
+				snapshot = queue_[which].snapshot;
+				queued = queue_[which].queued;
+				queue_.removeAt(which);
+				arm = snapshot_;
+				epoch = epoch_;
 			}
 		}
 
-		if (path != nullptr) {
-			emit progress("Generating data for path '" + path->name() + "'");
-			ArmMotionProfileGenerator gen(*this);
-			std::shared_ptr<ArmMotionProfile> profile = gen.generateProfile(path);
-			path->setProfile(profile);
+		if (path == nullptr) {
+			if (idle)
+				emit progress("Idle");
+			return;
 		}
 
-		if (!running_)
-			break;
-
-		bool sleep = false;
-		{
-			std::lock_guard guard(queue_lock_);
-			if (queue_.isEmpty()) {
-				emit progress("Idle");
-				sleep = true;
+		//
+		// An edit to the arm starts a new epoch, and the table for the arm as it was is no
+		// longer wanted
+		//
+		auto cancelled = [this, epoch]() { return !running_ || epoch_ != epoch; };
+
+		if (arm->count() > 0 && arm->usesLookupTable() && !arm->hasCurrentLookupTable()) {
+			std::lock_guard guard(table_lock_);
+			if (!arm->hasCurrentLookupTable()) {
+				emit progress("Building inverse kinematics table");
+				std::shared_ptr<const IKLookupTable> table = IKLookupTable::loadOrBuild(*arm, cancelled);
+				if (table == nullptr)
+					continue;
+
+				arm->setLookupTable(table);
+
+				//
+				// Later copies of the arm start with the table, and ignore it if the
+				// joints have changed since
+				//
+				arm_.setLookupTable(table);
 			}
 		}
 
-		if (sleep) {
-			std::this_thread::sleep_for(std::chrono::milliseconds(500));
+		auto start = std::chrono::steady_clock::now();
+		emit progress("Generating data for path '" + path->name() + "'");
+
+		try {
+			ArmMotionProfileGenerator gen(*arm, cancelled);
+			std::shared_ptr<ArmMotionProfile> profile = gen.generateProfile(snapshot);
+
+			//
+			// A job from a later epoch may be generating the same path, so only publish while
+			// this epoch is still the current one
+			//
+			{
+				std::lock_guard guard(queue_lock_);
+				if (epoch_ != epoch)
+					continue;
+
+				path->setCache(snapshot->cache());
+				path->setProfile(profile);
+			}
+
+			auto end = std::chrono::steady_clock::now();
+			double waited = std::chrono::duration<double, std::milli>(start - queued).count();
+			double ran = std::chrono::duration<double, std::milli>(end - start).count();
+			emit progress("Generated path '" + path->name() + "' in " + QString::number(ran, 'f', 1) + " ms, after waiting " + QString::number(waited, 'f', 1) + " ms");
+		}
+		catch (const GenerationCancelled&) {
+		}
+		catch (const std::exception& ex) {
+			emit progress("Path '" + path->name() + "' failed, " + QString(ex.what()));
 		}
 	}
 }
@@ -6,6 +6,7 @@
 #include "MathUtils.h"
 #include "Pose2d.h"
 #include "ChangeType.h"
+#include "ThreadPool.h"
 #include <QtCore/QPointF>
 #include <QtCore/QSizeF>
 #include <QtCore/QString>
@@ -15,8 +16,10 @@
 #include <QtCore/QJsonArray>
 #include <QtCore/QList>
 #include <memory>
-#include <thread>
+#include <atomic>
 #include <mutex>
+#include <cstdint>
+#include <chrono>
 
 class ArmMotionProfile;
 
@@ -115,7 +118,7 @@ public:
 		somethingChanged(ChangeType::Targets);
 	}
 
-	QVector<JointDataModel>& joints() {
+	const QVector<JointDataModel>& joints() const {
 		return arm_.joints();
 	}
 
@@ -146,6 +149,11 @@ public:
 		return arm_;
 	}
 
+	void setIKSolver(const QString& name) {
+		arm_.setIKSolver(name);
+		generateTrajectories();
+	}
+
 
 	bool hasPath(const QString& name) const {
 		return paths_.contains(name);
@@ -172,6 +180,12 @@ public:
 		paths_.remove(path->name());
 	}
 
+	void setPathType(std::shared_ptr<ArmPath> path, ArmPath::Type type) {
+		path->setType(type);
+		somethingChanged(ChangeType::PathType);
+		generateTrajectories();
+	}
+
 	void renamePath(const QString& oldname, const QString& newname) {
 		auto path = getPathByName(oldname);
 		assert(path != nullptr);
@@ -187,6 +201,12 @@ public:
 		return paths_.values();
 	}
 
+	//
+	// The path the user is looking at.  It is generated ahead of the others whenever it is
+	// waiting to be generated.
+	//
+	void setSelectedPath(std::shared_ptr<ArmPath> path);
+
 	void pathPointChanged() {
 		dirty_ = true;
 		emit dataChanged(ChangeType::PathPoint);
@@ -203,9 +223,21 @@ signals:
 	void dataChanged(ChangeType type);
 	void progress(const QString& msg);
 
+private:
+	//
+	// A path waiting to be generated, the copy of it taken when it was queued, and when it
+	// started waiting.  The generator reads the copy and the results are published on the path.
+	//
+	struct GenerationJob
+	{
+		std::shared_ptr<ArmPath> path;
+		std::shared_ptr<ArmPath> snapshot;
+		std::chrono::steady_clock::time_point queued;
+	};
+
 private:
 	void somethingChanged(ChangeType type);
-	void threadFunction();
+	void generateFunction();
 
 	QJsonArray targetsToJson();
 	QJsonArray jointsToJson();
@@ -223,7 +255,7 @@ private:
 	//
 	bool dirty_;
 
-	bool running_;
+	std::atomic<bool> running_;
 
 	RobotArm arm_;
 
@@ -252,7 +284,35 @@ private:
 	//
 	QVector<Translation2d> targets_;
 
+	//
+	// Paths waiting to be generated, and the copy of the arm they are generated with.  The
+	// generator only ever sees the copies, so the arm and the paths can be edited while paths
+	// are generated.
+	//
 	std::mutex queue_lock_;
-	std::thread generate_;
-	QVector<std::shared_ptr<ArmPath>> queue_;
+	QVector<GenerationJob> queue_;
+	std::shared_ptr<RobotArm> snapshot_;
+	std::shared_ptr<ArmPath> selected_;
+
+	//
+	// Bumped each time the queue is refilled.  A job remembers the epoch it took its path in and
+	// abandons the path, without publishing anything, once the epoch moves on.
+	//
+	std::atomic<uint64_t> epoch_;
+
+	//
+	// The number of jobs on the pool working through the queue
+	//
+	int active_;
+
+	//
+	// Held while building the inverse kinematics table so only one job builds it
+	//
+	std::mutex table_lock_;
+
+	//
+	// Generates independent paths at the same time.  Declared last so it is destroyed first,
+	// and the jobs still running finish before the rest of the model goes away.
+	//
+	ThreadPool pool_;
 };
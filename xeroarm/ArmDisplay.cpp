@@ -1,5 +1,6 @@
 #include "ArmDisplay.h"
 #include "ArmDataModel.h"
+#include "ArmMotionProfile.h"
 #include <QtWidgets/QMessageBox>
 #include <QtGui/QPainter>
 #include <QtGui/QMouseEvent>
@@ -36,6 +37,14 @@ ArmDisplay::ArmDisplay(ArmDataModel &model, QWidget* parent) : QWidget(parent),
 
 	(void)connect(&model_, &ArmDataModel::dataChanged, this, &ArmDisplay::redraw);
 
+	//
+	// A joint path is drawn from its profile, so draw it again as profiles are generated
+	//
+	(void)connect(&model_, &ArmDataModel::progress, this, [this](const QString&) {
+		if (path_ != nullptr && path_->type() == ArmPath::Type::Joint)
+			repaint();
+	});
+
 	dragging_ = false;
 	rotating_ = false;
 }
@@ -110,6 +119,9 @@ void ArmDisplay::mousePressEvent(QMouseEvent* ev)
 
 	if (ev->buttons() == Qt::RightButton) {
 		auto angles = model_.arm().inverseKinematics(Translation2d(pt.x(), pt.y()));
+		if (angles.isEmpty())
+			angles = model_.arm().globalInverseKinematics(Translation2d(pt.x(), pt.y()), model_.arm().angles());
+
 		if (angles.isEmpty()) {
 			QMessageBox::critical(this, "Error", "Cannot find a solution for the point selected");
 		}
@@ -350,6 +362,32 @@ void ArmDisplay::drawSpline(QPainter& paint, std::shared_ptr<SplinePair> pair)
 	}
 }
 
+void ArmDisplay::drawJointPath(QPainter& p)
+{
+	//
+	// The end effector of a joint path only follows a spline through the joint angles, so
+	// draw where the generated profile takes it, once there is one
+	//
+	auto profile = path_->profile();
+	if (profile == nullptr)
+		return;
+
+	p.save();
+
+	QColor c(0xF0, 0x80, 0x80, 0xFF);
+	QPen pen(c);
+	pen.setWidthF(0.2);
+	p.setPen(pen);
+
+	QPolygonF line;
+	for (const Pose2dTrajectory& pt : profile->trajectory()) {
+		line.push_back(QPointF(pt.getTranslation().getX(), pt.getTranslation().getY()));
+	}
+	p.drawPolyline(line);
+
+	p.restore();
+}
+
 void ArmDisplay::drawPoints(QPainter& p)
 {
 	for (int i = 0; i < path_->count(); i++) {
@@ -362,7 +400,10 @@ void ArmDisplay::drawCurrentPath(QPainter& p)
 	if (path_ == nullptr)
 		return;
 	
-	drawSplines(p);
+	if (path_->type() == ArmPath::Type::Joint)
+		drawJointPath(p);
+	else
+		drawSplines(p);
 	drawPoints(p);
 }
 
@@ -442,27 +483,24 @@ void ArmDisplay::drawJoint(QPainter& p, const QPointF& pt)
 
 void ArmDisplay::drawArms(QPainter &p)
 {
-	QPointF start(model_.armPos().getX(), model_.armPos().getY());
-	double baseangle = 0.0;
 	QPen pen;
 
 	if (model_.jointCount() > 0) {
-		for (int i = 0; i < model_.jointCount(); i++) {
-			double angle = baseangle + model_.jointModel(i).angle() * M_PI / 180.0;
-			double length = model_.jointModel(i).length();
+		QVector<Pose2d> frames = model_.arm().jointFrames(model_.arm().angles());
+		QPointF start(frames[0].getTranslation().getX(), frames[0].getTranslation().getY());
 
+		for (int i = 0; i < model_.jointCount(); i++) {
 			pen = QPen(colors_[i]);
 			pen.setCapStyle(Qt::RoundCap);
 			pen.setWidth(4);
 			p.setPen(pen);
 
-			QPointF end = QPointF(start.x() + std::cos(angle) * length, start.y() + std::sin(angle) * length);
+			QPointF end(frames[i + 1].getTranslation().getX(), frames[i + 1].getTranslation().getY());
 			p.drawLine(start, end);
 
 			drawJoint(p, start);
 
 			start = end;
-			baseangle = angle;
 		}
 
 		drawJoint(p, start);
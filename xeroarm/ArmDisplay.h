@@ -53,6 +53,7 @@ private:
 	void drawCurrentPath(QPainter& p);
 	void drawSplines(QPainter& p);
 	void drawSpline(QPainter& paint, std::shared_ptr<SplinePair> pair);
+	void drawJointPath(QPainter& p);
 	void drawPoints(QPainter& p);
 	void drawOnePoint(QPainter& paint, const Pose2d& pt, bool selected);
 	void drawJoint(QPainter& p, const QPointF& pt);
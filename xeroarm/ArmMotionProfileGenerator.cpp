@@ -1,447 +1,664 @@
 #include "ArmMotionProfileGenerator.h"
 #include "SplinePair.h"
-#include "Pose2dConstrained.h"
+#include "QuinticHermiteSpline.h"
+#include "ToppRA.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <string>
+
+ArmMotionProfileGenerator::ArmMotionProfileGenerator(const RobotArm& arm) : arm_(arm), global_left_(globalBudget)
+{
+}
 
-ArmMotionProfileGenerator::ArmMotionProfileGenerator(ArmDataModel &model) : model_(model)
+ArmMotionProfileGenerator::ArmMotionProfileGenerator(const RobotArm& arm, std::function<bool()> cancelled) : arm_(arm), cancelled_(cancelled), global_left_(globalBudget)
 {
 }
 
-QVector<std::shared_ptr<SplinePair>> ArmMotionProfileGenerator::computeSplinesForPath(std::shared_ptr<ArmPath> path)
+void ArmMotionProfileGenerator::checkCancelled() const
 {
-	QVector<std::shared_ptr<SplinePair>> splines;
+	if (cancelled_ && cancelled_())
+		throw GenerationCancelled();
+}
 
-	for (int i = 0; i < path->size() - 1; i++) {
-		const Pose2d& p1 = path->at(i);
-		const Pose2d& p2 = path->at(i + 1);
-		auto pair = std::make_shared<SplinePair>(p1, p2);
-		splines.push_back(pair);
-	}
+QVector<double> ArmMotionProfileGenerator::globalSolve(const Translation2d& pt, const QVector<double>& seed)
+{
+	//
+	// A path near the edge of the workspace can have hundreds of points the selected solver
+	// misses, and the global search takes up to a tenth of a second for each, so it only gets
+	// globalBudget for the whole path.  Once that is spent the points stay unsolved.
+	//
+	if (global_left_ <= 0.0)
+		return QVector<double>();
+
+	checkCancelled();
 
-	return splines;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	QVector<double> ret = arm_.globalInverseKinematics(pt, seed);
+	global_left_ -= std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	return ret;
 }
 
-void ArmMotionProfileGenerator::getSegmentArc(std::shared_ptr<SplinePair> pair, QVector<Pose2dTrajectory>& results,
-	double t0, double t1, double maxDx, double maxDy, double maxDTheta)
+bool ArmMotionProfileGenerator::needsSplit(const Pose2d& left, const Pose2d& mid, const Pose2d& right, double arc, const ArmPath::Tolerances& tolerances)
 {
-	const Translation2d& p0 = pair->evalPosition(t0);
-	const Translation2d& p1 = pair->evalPosition(t1);
-	const Rotation2d& r0 = pair->evalHeading(t0);
-	const Rotation2d& r1 = pair->evalHeading(t1);
-	Pose2d transformation = Pose2d(Translation2d(p0, p1).rotateBy(r0.inverse()), r1.rotateBy(r0.inverse()));
-	Twist2d twist = Pose2d::logfn(transformation);
-	if (twist.getY() > maxDy || twist.getX() > maxDx || twist.getTheta() > maxDTheta) {
-		getSegmentArc(pair, results, t0, (t0 + t1) / 2, maxDx, maxDy, maxDTheta);
-		getSegmentArc(pair, results, (t0 + t1) / 2, t1, maxDx, maxDy, maxDTheta);
+	if (arc > tolerances.maxStep)
+		return true;
+
+	if (arc < 2.0 * tolerances.minStep)
+		return false;
+
+	Translation2d chord = right.getTranslation() - left.getTranslation();
+	Translation2d offset = mid.getTranslation() - left.getTranslation();
+	double length = chord.normalize();
+
+	//
+	// How far the middle of the piece is from the straight line across it, which grows with
+	// the curvature
+	//
+	double deviation = (length > MathUtils::kEpsilon) ? std::fabs(Translation2d::cross(chord, offset)) / length : offset.normalize();
+	if (deviation > tolerances.maxDeviation)
+		return true;
+
+	//
+	// The headings are the direction of the spline, so on a piece that is close to straight
+	// both ends point along the line across it.  Comparing them with each other as well catches
+	// an S bend whose middle happens to fall on the line.
+	//
+	double turn = std::fabs(right.getRotation().rotateBy(left.getRotation().inverse()).toDegrees());
+	if (length > MathUtils::kEpsilon) {
+		Rotation2d direction(chord.getX(), chord.getY(), true);
+		turn = std::max(turn, std::fabs(left.getRotation().rotateBy(direction.inverse()).toDegrees()));
+		turn = std::max(turn, std::fabs(right.getRotation().rotateBy(direction.inverse()).toDegrees()));
 	}
-	else {
-		results.push_back(Pose2dTrajectory(model_.jointCount(), pair->evalPose(t1)));
+
+	return turn > tolerances.maxHeading;
+}
+
+void ArmMotionProfileGenerator::sampleSegment(ProfileCache::Segment& segment, const ArmPath::Tolerances& tolerances)
+{
+	//
+	// Split the spline in half, by distance along it, until each piece is within the
+	// tolerances.  The pieces still to look at are kept on a stack, the leftmost on top, so
+	// samples come out in order.  The middle of a piece that is split becomes an end of its
+	// two halves, so the spline is evaluated once for each sample and once more for each piece
+	// that is kept.
+	//
+	struct Knot
+	{
+		double t;
+		double dist;
+		Pose2d pose;
+	};
+
+	std::shared_ptr<SplinePair> spline = segment.spline;
+	Knot left = { 0.0, 0.0, spline->evalPose(0.0) };
+	QVector<Knot> pending;
+	pending.push_back({ 1.0, spline->length(), spline->evalPose(1.0) });
+
+	segment.samples.clear();
+	segment.params.clear();
+	segment.samples.push_back(Pose2dTrajectory(arm_.count(), left.pose));
+	segment.params.push_back(left.t);
+
+	while (!pending.isEmpty()) {
+		const Knot right = pending.back();
+
+		if (right.t - left.t > minParamStep) {
+			double dist = (left.dist + right.dist) / 2.0;
+			double t = spline->paramAtDistance(dist);
+			Pose2d mid = spline->evalPose(t);
+			if (needsSplit(left.pose, mid, right.pose, right.dist - left.dist, tolerances)) {
+				pending.push_back({ t, dist, mid });
+				continue;
+			}
+		}
+
+		pending.pop_back();
+		segment.samples.push_back(Pose2dTrajectory(arm_.count(), right.pose));
+		segment.params.push_back(right.t);
+		left = right;
 	}
 }
 
-QVector<Pose2dTrajectory> ArmMotionProfileGenerator::makeDiscrete(const QVector<std::shared_ptr<SplinePair>>& splines, double maxDx, double maxDy, double maxDTheta)
+void ArmMotionProfileGenerator::refineSegment(ProfileCache::Segment& segment, const ArmPath::Tolerances& tolerances)
 {
-	QVector<Pose2dTrajectory> results;
+	//
+	// The sampler only looks at the path.  Near the edge of the arm's reach a short step along
+	// the path can swing the joints a long way, and the timing pass needs samples there to see
+	// it, so split the pieces where the joints move further than the tolerance allows.
+	//
+	QVector<Pose2dTrajectory>& samples = segment.samples;
+	QVector<double>& params = segment.params;
 
-	results.push_back(Pose2dTrajectory(model_.jointCount(), splines[0]->getStartPose()));
-	for (int i = 0; i < splines.size(); i++)
-		getSegmentArc(splines[i], results, 0.0, 1.0, maxDx, maxDy, maxDTheta);
+	int i = 0;
+	while (i < samples.count() - 1) {
+		QVector<double> a = samples[i].angles();
+		const QVector<double>& b = samples[i + 1].angles();
 
-	return results;
+		double d0 = segment.spline->distance(params[i]);
+		double d1 = segment.spline->distance(params[i + 1]);
+
+		if (a.isEmpty() || b.isEmpty() || params[i + 1] - params[i] <= minParamStep || d1 - d0 < 2.0 * tolerances.minStep ||
+			jointDistance(a, b) <= tolerances.maxJointStep) {
+			i++;
+			continue;
+		}
+
+		checkCancelled();
+
+		double t = segment.spline->paramAtDistance((d0 + d1) / 2.0);
+		Pose2dTrajectory sample(arm_.count(), segment.spline->evalPose(t));
+		QVector<double> angles = arm_.inverseKinematics(sample.getTranslation(), a);
+		if (angles.isEmpty())
+			angles = globalSolve(sample.getTranslation(), a);
+
+		sample.setAngles(angles);
+
+		samples.insert(i + 1, sample);
+		params.insert(i + 1, t);
+	}
 }
 
-QVector<Pose2dTrajectory> ArmMotionProfileGenerator::makeEqualDistance(const QVector<Pose2dTrajectory>& points, double step)
+void ArmMotionProfileGenerator::solveSegment(ProfileCache::Segment& segment, const QVector<double>& prev, const ArmPath::Tolerances& tolerances)
 {
-	QVector<double> distances;
-	QVector<Pose2dTrajectory> result;
+	//
+	// Neighboring samples are close together, so solve them all at once and let the solver
+	// continue each one from the solution for the sample before it.  The first sample is the
+	// last one of the segment before, so it keeps the angles that segment ended with and the
+	// rest continue from there, just as they would if the whole path were solved in one go.
+	//
+	QVector<Pose2dTrajectory>& samples = segment.samples;
+	int first = 0;
 
-	static const double kEpsilon = 1e-6;
-	double d;
+	segment.seed = prev;
+	if (!prev.isEmpty()) {
+		samples[0].setAngles(prev);
+		first = 1;
+	}
 
-	distances.push_back(0.0);
-	for (int i = 1; i < points.size(); i++)
-		distances.push_back(points[i].distance(points[i - 1]) + distances[i - 1]);
+	QVector<Translation2d> targets;
+	for (int i = first; i < samples.count(); i++) {
+		targets.push_back(samples[i].getTranslation());
+	}
 
-	int index = 0;
-	for (d = 0.0; d <= distances.back(); d += step)
-	{
-		while (d > distances[index + 1])
-			index++;
+	Eigen::MatrixXd seeds;
+	if (!prev.isEmpty()) {
+		seeds.resize(arm_.count(), 1);
+		for (int j = 0; j < arm_.count(); j++) {
+			seeds(j, 0) = prev[j];
+		}
+	}
 
-		double percent = (d - distances[index]) / (distances[index + 1] - distances[index]);
-		Pose2dTrajectory newpttraj(model_.jointCount(), points[index].interpolate(points[index + 1], percent));
+	Eigen::MatrixXd solved = arm_.inverseKinematicsBatch(targets, seeds);
 
-		QVector<double> angles = model_.arm().inverseKinematics(newpttraj.getTranslation());
-		if (angles.isEmpty()) {
-			qDebug() << "IK failed, newpttraj: " << newpttraj.getTranslation().getX() << ", " << newpttraj.getTranslation().getY();
+	//
+	// Give the samples the batch missed to the global search, starting from the sample before
+	//
+	QVector<double> last = prev;
+	for (int col = 0; col < targets.count(); col++) {
+		QVector<double> angles;
+
+		if (solved.col(col).hasNaN()) {
+			angles = globalSolve(targets[col], last);
+		}
+		else {
+			for (int j = 0; j < solved.rows(); j++) {
+				angles.push_back(solved(j, col));
+			}
 		}
-		newpttraj.setAngles(angles);
 
-		result.push_back(newpttraj);
+		samples[first + col].setAngles(angles);
+		if (!angles.isEmpty())
+			last = angles;
 	}
 
-	distances.clear();
-	distances.push_back(0.0);
-	for (int i = 1; i < result.size(); i++)
-		distances.push_back(result[i].distance(result[i - 1]) + distances[i - 1]);
+	refineSegment(segment, tolerances);
+	trackBranches(samples);
+}
 
-	return result;
+ProfileCache::Segment ArmMotionProfileGenerator::newSegment(const Pose2d& p1, const Pose2d& p2, std::shared_ptr<SplinePair> spline, const QVector<double>& prev,
+	const ArmPath::Tolerances& tolerances)
+{
+	ProfileCache::Segment segment;
+	segment.start = p1;
+	segment.end = p2;
+	segment.spline = (spline != nullptr) ? spline : std::make_shared<SplinePair>(p1, p2);
+	sampleSegment(segment, tolerances);
+	solveSegment(segment, prev, tolerances);
+
+	return segment;
 }
 
-double ArmMotionProfileGenerator::computeOneJointConstraintVelLimited(int which, const Pose2dConstrained& pred, double dist, double accel)
+QVector<Pose2dTrajectory> ArmMotionProfileGenerator::joinSegments(const QVector<ProfileCache::Segment>& segments, QVector<double>& distances)
 {
 	//
-	// The part of the motion that is accelerating from the previous velocity to the maximum velocity
+	// Each segment starts where the one before it ended, so leave out the repeated sample.  The
+	// distance to each sample is measured along the splines.
 	//
-	double t0;
-	
-	if (accel >= 0.0) {
-		t0 = (model_.arm().joints().at(which).maxVelocity() - pred.angVel(which)) / accel;
+	QVector<Pose2dTrajectory> result;
+	double start = 0.0;
+
+	distances.clear();
+	for (int i = 0; i < segments.count(); i++) {
+		for (int j = (i == 0) ? 0 : 1; j < segments[i].samples.count(); j++) {
+			result.push_back(segments[i].samples[j]);
+			distances.push_back(start + segments[i].spline->distance(segments[i].params[j]));
+		}
+		start += segments[i].spline->length();
 	}
-	else {
-		t0 = (-model_.arm().joints().at(which).maxVelocity() - pred.angVel(which)) / accel;
+
+	return result;
+}
+
+double ArmMotionProfileGenerator::jointDistance(const QVector<double>& a, const QVector<double>& b)
+{
+	double ret = 0.0;
+	for (int i = 0; i < a.count(); i++) {
+		double delta = MathUtils::boundDegrees(a[i] - b[i]);
+		ret += delta * delta;
 	}
 
-	double d0 = 0.5 * model_.arm().joints().at(which).maxAccel() * t0 * t0 + pred.angVel(which) * t0;
+	return std::sqrt(ret);
+}
 
+double ArmMotionProfileGenerator::jointTravel(const QVector<double>& a, const QVector<double>& b)
+{
 	//
-	// We have already determined that this should be a hybrid case, where we accelerate for only part of the cycle, so this distance
-	// should always be smaller than the total distance
+	// Unlike jointDistance the differences are not wrapped, so a joint that goes the long way
+	// around counts the whole way
 	//
-	assert(d0 < dist);
+	double ret = 0.0;
+	for (int i = 0; i < a.count(); i++) {
+		double delta = b[i] - a[i];
+		ret += delta * delta;
+	}
 
+	return std::sqrt(ret);
+}
+
+void ArmMotionProfileGenerator::trackBranches(QVector<Pose2dTrajectory>& points)
+{
 	//
-	// The remainder of the distance is covered via constanct velocity, accel is zero.
+	// The solver for a sample may land on a different elbow branch than the sample before
+	// it, or wrap a joint across +/-180.  Either looks like a huge joint move to the timing
+	// pass and the profile crawls through it.  Walk the path and, where a sample jumps away
+	// from the one before it, solve it again from the previous sample and keep whichever
+	// solution is closer.  Unwrap the angles so they are continuous.  These are the angles
+	// every later pass uses, so nothing after this solves again.
 	//
-	double d1 = (dist - d0);
-	double t1 = d1 / model_.arm().joints().at(which).maxVelocity();
+	QVector<double> prev;
+
+	for (Pose2dTrajectory& point : points) {
+		checkCancelled();
+
+		QVector<double> angles = point.angles();
+
+		if (!prev.isEmpty() && (angles.isEmpty() || jointDistance(angles, prev) > branchJump)) {
+			QVector<double> near = arm_.inverseKinematics(point.getTranslation(), prev);
+			if (angles.isEmpty() || (!near.isEmpty() && jointDistance(near, prev) < jointDistance(angles, prev)))
+				angles = near;
 
-	return t0 + t1;
+			if (angles.isEmpty())
+				angles = globalSolve(point.getTranslation(), prev);
+		}
+
+		if (angles.isEmpty())
+			continue;
+
+		if (!prev.isEmpty()) {
+			for (int i = 0; i < angles.count(); i++) {
+				angles[i] = MathUtils::unwrapDegrees(angles[i], prev[i]);
+			}
+		}
+
+		point.setAngles(angles);
+		prev = angles;
+	}
 }
 
-double ArmMotionProfileGenerator::computeOneJointConstraint(int iter, int which, const Pose2dConstrained& pred, double dist)
+std::shared_ptr<ArmMotionProfile> ArmMotionProfileGenerator::generateTimedProfile(std::shared_ptr<ArmPath> path, const QVector<Pose2dTrajectory>& view,
+	const QVector<double>& distances, std::shared_ptr<const ToppRA> previous, std::shared_ptr<const ToppRA>& timing)
 {
-	QVector<std::pair<double, double>> roots;
-	double z;
-	double accel = model_.arm().joints().at(which).maxAccel();
-	
-	z = 4.0 * pred.angVel(which) + 8.0 * accel * dist;
-	if (z >= 0.0) {
-		z = std::sqrt(z);
-		roots.push_back(std::make_pair(accel, (-2.0 * pred.angVel(which) + z) / (2.0 * model_.arm().joints().at(which).maxAccel())));
-		roots.push_back(std::make_pair(accel, (-2.0 * pred.angVel(which) - z) / (2.0 * model_.arm().joints().at(which).maxAccel())));
-	}
+	//
+	// The path parameter is the distance traveled along the path, so for a cartesian path its
+	// velocity and acceleration are those of the end effector.  Points that do not move along
+	// the path add nothing to the profile and are dropped.
+	//
+	QVector<int> used;
+	QVector<double> stations;
+	QVector<QVector<double>> angles;
+
+	for (int i = 0; i < view.size(); i++) {
+		if (view[i].angles().count() != arm_.count()) {
+			const Translation2d& pt = view[i].getTranslation();
+			throw std::runtime_error("no joint angles for the point " + QString::number(pt.getX(), 'f', 2).toStdString() + ", " +
+				QString::number(pt.getY(), 'f', 2).toStdString() + " on the path");
+		}
 
-	z = 4.0 * pred.angVel(which) - 8.0 * model_.arm().joints().at(which).maxAccel() * dist;
-	if (z >= 0.0) {
-		z = std::sqrt(z);
-		roots.push_back(std::make_pair(-accel, (-2.0 * pred.angVel(which) + z) / (2.0 * model_.arm().joints().at(which).maxAccel())));
-		roots.push_back(std::make_pair(-accel, (-2.0 * pred.angVel(which) - z) / (2.0 * model_.arm().joints().at(which).maxAccel())));
-	}
+		double s = distances[i];
+		if (!used.isEmpty() && s <= stations.back())
+			continue;
 
-	if (roots.size() == 0) {
-		return std::numeric_limits<double>::max();
+		used.push_back(i);
+		stations.push_back(s);
+		angles.push_back(view[i].angles());
 	}
 
-
-	// Now pick the smallest, positive root
-	double ret = std::numeric_limits<double>::max();
-	double aval = 0.0;
-	for (const auto &p : roots) {
-		if (p.second < ret && p.second >= 0.0) {
-			ret = p.second;
-			aval = p.first;
-		}
+	QVector<double> maxvel, maxaccel, maxjerk;
+	for (const JointDataModel& joint : arm_.joints()) {
+		maxvel.push_back(joint.maxVelocity());
+		maxaccel.push_back(joint.maxAccel());
+		maxjerk.push_back(joint.maxJerk());
 	}
 
 	//
-	// Now, see if the computed times lead to a valid velocity that does not 
-	// violate the velocity constraints
+	// Only the part of the path that changed since the last time needs solving again
 	//
-	double vf = pred.angVel(which) + aval * ret;
-	if (std::abs(vf) > model_.arm().joints().at(which).maxVelocity()) {
-		//
-		// Ok, we are constrained by the max velocity, lets compute the time based on accelerating
-		// from current velocity to max velocity and then staying at max velocity until we hit the
-		// target position
-		//
-		ret = computeOneJointConstraintVelLimited(which, pred, dist, aval);
+	auto solution = std::make_shared<ToppRA>(maxvel, maxaccel);
+	solution->setCancel(cancelled_);
+	solution->setMaxJerk(maxjerk);
+	if (!solution->solve(stations, angles, previous.get())) {
+		checkCancelled();
+		throw std::runtime_error("the path cannot be followed within the joint limits");
 	}
 
-	return ret;
-}
+	timing = solution;
+	const ToppRA& topp = *solution;
 
-double ArmMotionProfileGenerator::jointConstrainedVelocity(int iter, Pose2dConstrained& state, const Pose2dConstrained &pred)
-{
-	QVector<double> curang = model_.arm().inverseKinematics(state.pose().getTranslation());
-	QVector<double> prevang = model_.arm().inverseKinematics(pred.pose().getTranslation());
-	QVector<double> times(model_.arm().count());
-	const auto& joints = model_.arm().joints();
-
-	//
-	// Compute the time it takes each joint to move given its maximum velocity
-	//
-	double maxval = 0.0;
-	int index = -1;
-	for (int i = 0; i < times.size(); i++) {
-		double dist = curang.at(i) - prevang.at(i);
-		times[i] = computeOneJointConstraint(iter, i, pred, dist);
-		if (times[i] > maxval) {
-			index = i;
-			maxval = times[i];
+	QVector<Pose2dTrajectory> result;
+
+	for (int k = 0; k < used.count(); k++) {
+		QVector<double> avel, aaccel;
+
+		for (int j = 0; j < arm_.count(); j++) {
+			avel.push_back(topp.jointVelocity(k, j));
+			aaccel.push_back(topp.jointAcceleration(k, j));
 		}
-	}
 
-	state.setLimitingJoint(index);
-	state.setDuration(maxval);
+		Pose2dTrajectory trajpt(view[used[k]], topp.time(k), stations[k], topp.velocity(k), topp.acceleration(k));
+		trajpt.setVelocities(avel);
+		trajpt.setAaccel(aaccel);
 
-	if (maxval == 0.0) {
-		//
-		// We are not moving, so our max velocity constraint should be max velocity
-		// 
-		return std::numeric_limits<double>::max();
+		result.push_back(trajpt);
 	}
 
-	//
-	// Ok the joint with the greatest travel time is the one constraining the 
-	// motion (i.e. the value of index)
-	//
+	return std::make_shared<ArmMotionProfile>(path, result);
+}
 
+QVector<QVector<double>> ArmMotionProfileGenerator::solveWaypoints(std::shared_ptr<ArmPath> path)
+{
 	//
-	// Now that we know the time required between the points based on the slowest joint
-	// we can compute the velocity of the end effector that aligns with that time
+	// Each waypoint is solved from the one before it, so the arm stays on the same branch
+	// where it can, and the angles are unwrapped to be continuous from one waypoint to the next.
+	// A joint with limits has to go the long way around rather than through them, so its angles
+	// are left as solved.
 	//
-	return (state.position() - pred.position()) / maxval;
+	QVector<QVector<double>> result;
+
+	for (int i = 0; i < path->size(); i++) {
+		checkCancelled();
+
+		const Translation2d& pt = path->at(i).getTranslation();
+		QVector<double> angles = result.isEmpty() ? arm_.inverseKinematics(pt) : arm_.inverseKinematics(pt, result.back());
+		if (angles.isEmpty())
+			angles = globalSolve(pt, result.isEmpty() ? QVector<double>() : result.back());
+
+		if (angles.isEmpty())
+			throw std::runtime_error("waypoint " + std::to_string(i + 1) + " is out of the reach of the arm");
+
+		if (!result.isEmpty()) {
+			for (int j = 0; j < angles.count(); j++) {
+				if (!arm_.at(j).isConstrained())
+					angles[j] = MathUtils::unwrapDegrees(angles[j], result.back()[j]);
+			}
+		}
+
+		result.push_back(angles);
+	}
+
+	return result;
 }
 
-void ArmMotionProfileGenerator::computeJointMetrics(Pose2dConstrained& state, const Pose2dConstrained& pred)
+void ArmMotionProfileGenerator::effectorMotion(QVector<Pose2dTrajectory>& points)
 {
 	//
-	// We know the distance, velocity, and time for the end effector position
+	// The timing pass leaves the distance, velocity and acceleration along the path parameter,
+	// which for a joint path is measured in joint angles.  Replace them with the motion of the
+	// end effector, which is what they mean for a cartesian path, from differences between the
+	// points.  The profile starts and ends at rest.
 	//
-	QVector<double> curang = model_.arm().inverseKinematics(state.pose().getTranslation());
-	QVector<double> prevang = model_.arm().inverseKinematics(pred.pose().getTranslation());
-
-	for (int i = 0; i < model_.arm().joints().size(); i++) {
-		state.setAngPos(i, curang.at(i));
+	double dist = 0.0;
+	for (int i = 0; i < points.count(); i++) {
+		if (i > 0)
+			dist += (points[i].getTranslation() - points[i - 1].getTranslation()).normalize();
+		points[i].setPosition(dist);
+	}
 
-		if (state.duration() == 0.0) {
-			state.setAngVel(i, 0.0);
+	for (int i = 0; i < points.count(); i++) {
+		double vel = 0.0;
+		if (i > 0 && i < points.count() - 1) {
+			double dt = points[i + 1].time() - points[i - 1].time();
+			if (dt > 0.0)
+				vel = (points[i + 1].position() - points[i - 1].position()) / dt;
 		}
-		else {
-			double angvel = (curang.at(i) - prevang.at(i)) / state.duration();
-			state.setAngVel(i, angvel);
+		points[i].setVelocity(vel);
+	}
+
+	for (int i = 0; i < points.count(); i++) {
+		double accel = 0.0;
+		if (i < points.count() - 1) {
+			double dt = points[i + 1].time() - points[i].time();
+			if (dt > 0.0)
+				accel = (points[i + 1].velocity() - points[i].velocity()) / dt;
 		}
+		points[i].setAccel(accel);
 	}
 }
 
-std::shared_ptr<ArmMotionProfile> ArmMotionProfileGenerator::generateTimedProfile(std::shared_ptr<ArmPath> path, const QVector<Pose2dTrajectory>& view)
+std::shared_ptr<ArmMotionProfile> ArmMotionProfileGenerator::generateJointProfile(std::shared_ptr<ArmPath> path)
 {
-	QVector<Pose2dConstrained> points;
-	Pose2dConstrained predecessor(model_.jointCount());
-	const static double kEpsilon = 1e-6;
-
 	//
-	// These are very big, but should be constrained by the per joint angle velocity and acceleration
+	// Step 1: Solve for the joint angles at each waypoint.  These are the only inverse kinematics
+	//         a joint path needs.
 	//
-	double maxaccel = 1000000;
-	double maxvel = 1000000;
-
-	predecessor.setPosition(0.0);
-	predecessor.setPose(view[static_cast<int>(0)]);
-	predecessor.setVelocity(0);
-	predecessor.setAccelMin(-maxaccel);
-	predecessor.setAccelMax(maxaccel);
+	QVector<QVector<double>> waypoints = solveWaypoints(path);
 
 	//
-	// Forward pass
+	// Step 2: Join the waypoints with a quintic spline per joint and segment.  Each segment is
+	//         parameterized by its length in joint space, and the joint velocities at an interior
+	//         waypoint point from the waypoint before it to the one after it, so the velocities
+	//         carry across the waypoints.  The accelerations are zero at the waypoints, so they
+	//         carry across as well.
 	//
-	for (int i = 0; i < view.size(); i++)
-	{
-		Pose2dConstrained state(model_.jointCount());
-		state.setPose(view[i]);
+	QVector<double> lengths;
+	for (int i = 0; i < waypoints.count() - 1; i++) {
+		lengths.push_back(jointTravel(waypoints[i], waypoints[i + 1]));
+	}
 
-		double dist = predecessor.pose().distance(state.pose());
-		state.setPosition(predecessor.position() + dist);
+	auto slope = [&waypoints, &lengths](int i, int joint) {
+		int before = std::max(i - 1, 0);
+		int after = std::min(i + 1, static_cast<int>(waypoints.count()) - 1);
+		double length = 0.0;
+		for (int k = before; k < after; k++) {
+			length += lengths[k];
+		}
+		return (length > MathUtils::kEpsilon) ? (waypoints[after][joint] - waypoints[before][joint]) / length : 0.0;
+	};
 
-		while (true)
-		{
-			double calcvel = std::sqrt(predecessor.velocity() * predecessor.velocity() + 2.0 * predecessor.accelMax() * dist);
-			state.setVelocity(std::min(maxvel, calcvel));
+	QVector<QVector<double>> slopes(waypoints.count());
+	for (int i = 0; i < waypoints.count(); i++) {
+		for (int j = 0; j < arm_.count(); j++) {
+			slopes[i].push_back(slope(i, j));
+		}
+	}
 
-			if (std::isnan(state.velocity()))
-				throw std::runtime_error("invalid maximum velocity");
+	const ArmPath::Tolerances& tolerances = path->tolerances();
 
-			state.setAccelMin(-maxaccel);
-			state.setAccelMax(maxaccel);
+	auto jointSpline = [&waypoints, &lengths, &slopes](int i, int joint) {
+		return QuinticHermiteSpline(waypoints[i][joint], waypoints[i + 1][joint], lengths[i] * slopes[i][joint], lengths[i] * slopes[i + 1][joint], 0.0, 0.0);
+	};
 
-			double convel = jointConstrainedVelocity(i, state, predecessor);
-			state.setVelocity(std::min(state.velocity(), convel));
-			computeJointMetrics(state, predecessor);
+	auto jointSteps = [&lengths, &tolerances](int i) {
+		return std::max(2, static_cast<int>(std::ceil(lengths[i] / tolerances.maxJointStep)));
+	};
 
-			if (state.velocity() < 0.0)
-				throw std::runtime_error("invalid maximum velocity - constraint set to negative");
+	//
+	// Step 3: A spline can overshoot the waypoints at its ends, which may take a joint past its
+	//         limits.  Where it does, the velocity of the joint at both ends of the segment is
+	//         made zero, which keeps the spline between the two waypoints.  That changes the
+	//         segments on either side too, so check again until every joint stays within its
+	//         limits.  A joint that is past its limits at a waypoint cannot be helped.
+	//
+	for (bool clamped = true; clamped; ) {
+		checkCancelled();
+		clamped = false;
+
+		for (int i = 0; i < lengths.count(); i++) {
+			if (lengths[i] < MathUtils::kEpsilon)
+				continue;
+
+			int steps = jointSteps(i);
+			for (int j = 0; j < arm_.count(); j++) {
+				if (!arm_.at(j).isConstrained())
+					continue;
+
+				QuinticHermiteSpline spline = jointSpline(i, j);
+				bool within = true;
+				for (int k = 0; k <= steps && within; k++) {
+					within = arm_.at(j).withinLimits(spline.eval(static_cast<double>(k) / steps));
+				}
 
-			if (dist < kEpsilon)
-				break;
+				if (within)
+					continue;
 
-			double actaccel = (state.velocity() * state.velocity() - predecessor.velocity() * predecessor.velocity()) / (2.0 * dist);
-			if (state.accelMax() < actaccel - kEpsilon)
-			{
-				predecessor.setAccelMax(state.accelMax());
-				if (i != 0)
-					points[i - 1] = predecessor;
-			}
-			else
-			{
-				if (actaccel > predecessor.accelMin() + kEpsilon)
-				{
-					predecessor.setAccelMax(actaccel);
-					if (i != 0)
-						points[i - 1] = predecessor;
-				}
-				break;
+				if (slopes[i][j] == 0.0 && slopes[i + 1][j] == 0.0)
+					throw std::runtime_error("joint " + std::to_string(j + 1) + " is past its limits between waypoints " + std::to_string(i + 1) + " and " + std::to_string(i + 2));
+
+				slopes[i][j] = 0.0;
+				slopes[i + 1][j] = 0.0;
+				clamped = true;
 			}
 		}
-		points.push_back(state);
-		predecessor = state;
 	}
 
 	//
-	// Backward pass
+	// Step 4: Sample the splines closely enough that no joint moves further than the tolerance
+	//         from one sample to the next.  The station of a sample is its distance in joint
+	//         space from the start of the path, which the splines move along at an even rate.
 	//
-	int last = view.size() - 1;
-	Pose2dConstrained sucessor(model_.jointCount());
-	sucessor.setPose(view[last]);
-	sucessor.setPosition(points[last].position());
-	sucessor.setVelocity(0.0);
-	sucessor.setAccelMin(-maxaccel);
-	sucessor.setAccelMax(maxaccel);
+	QVector<Pose2dTrajectory> samples;
+	QVector<double> stations;
+	double start = 0.0;
 
-	for (int i = points.size() - 1; i >= 0; i--)
-	{
-		Pose2dConstrained state = points[i];
-		double dist = state.position() - sucessor.position();				// Will be negative
-
-		while (true)
-		{
-			double tmp = sucessor.velocity() * sucessor.velocity() + 2.0 * sucessor.accelMin() * dist;
-			double newmaxvel = std::sqrt(tmp);
-			if (newmaxvel >= state.velocity())
-				break;
-
-			if (std::isnan(newmaxvel))
-				throw std::runtime_error("invalid new maximum velocity");
-
-			state.setVelocity(newmaxvel);
-			computeJointMetrics(state, predecessor);
-			points[i] = state;
-
-			if (dist > kEpsilon)
-				break;
-
-			double actaccel = (state.velocity() * state.velocity() - sucessor.velocity() * sucessor.velocity()) / (2.0 * dist);
-			if (state.accelMin() > actaccel + kEpsilon)
-			{
-				sucessor.setAccelMin(state.accelMin());
-				if (i != points.size() - 1)
-					points[i + 1] = sucessor;
-			}
-			else
-			{
-				sucessor.setAccelMin(actaccel);
-				if (i != points.size() - 1)
-					points[i + 1] = sucessor;
+	for (int i = 0; i < lengths.count(); i++) {
+		checkCancelled();
 
-				break;
-			}
-		}
-		sucessor = state;
-	}
+		double length = lengths[i];
+		if (length < MathUtils::kEpsilon)
+			continue;
 
-	double t = 0.0;
-	double s = 0.0;
-	double v = 0.0;
-	QVector<Pose2dTrajectory> result;
+		QVector<QuinticHermiteSpline> splines;
+		for (int j = 0; j < arm_.count(); j++) {
+			splines.push_back(jointSpline(i, j));
+		}
 
-	for (int i = 0; i < points.size(); i++)
-	{
-		QVector<double> avel, aacel;
+		int steps = jointSteps(i);
+		for (int k = samples.isEmpty() ? 0 : 1; k <= steps; k++) {
+			double t = static_cast<double>(k) / steps;
 
-		const Pose2dConstrained& state = points[i];
-		double ds = state.position() - s;
-		double accel = (state.velocity() * state.velocity() - v * v) / (2.0 * ds);
-		double dt = 0;
-		if (i > 0)
-		{
-			result[i - 1].setAccel(accel);
-			if (std::fabs(accel) > kEpsilon)
-			{
-				dt = (state.velocity() - v) / accel;
-			}
-			else
-			{
-				dt = ds / v;
+			QVector<double> angles;
+			for (QuinticHermiteSpline& spline : splines) {
+				angles.push_back(spline.eval(t));
 			}
 
-			for (int j = 0; j < model_.jointCount(); j++) {
-				double aveln = (points[i - 1].pose().angles().at(j) - points[i].pose().angles().at(j)) / dt;
-				double aaceln = (result[i - 1].velocities().at(j) - aveln) / dt;
-				avel.push_back(aveln);
-				aacel.push_back(aaceln);
-			}
+			Pose2dTrajectory sample(arm_.count(), arm_.jointFrames(angles).back());
+			sample.setAngles(angles);
+			samples.push_back(sample);
+			stations.push_back(start + length * t);
 		}
-		else {
-			avel.resize(model_.jointCount());
-			aacel.resize(model_.jointCount());
-		}
-
-		t += dt;
-		if (std::isinf(t) || std::isnan(t))
-			throw std::runtime_error("invalid time value integrating forward");
 
-		v = state.velocity();
-		s = state.position();
+		start += length;
+	}
 
-		Pose2dTrajectory trajpt(view[i], t, s, v, accel);
-		trajpt.setVelocities(avel);
-		trajpt.setAaccel(aacel);
+	if (samples.isEmpty())
+		throw std::runtime_error("the path does not move the arm");
 
-		result.push_back(trajpt);
-	}
+	//
+	// Step 5: Generate a timing view that meets the constraints of the system.  There is
+	//         nothing to reuse from the last run, the path is cheap to sample from scratch.
+	//
+	checkCancelled();
+	std::shared_ptr<const ToppRA> timing;
+	std::shared_ptr<ArmMotionProfile> profile = generateTimedProfile(path, samples, stations, nullptr, timing);
 
-	for (Pose2dTrajectory& point : result) {
-		model_.arm().inverseKinematics(point.getTranslation());
-	}
+	QVector<Pose2dTrajectory> points = profile->trajectory();
+	effectorMotion(points);
 
-	return std::make_shared<ArmMotionProfile>(path, result);
+	return std::make_shared<ArmMotionProfile>(path, points);
 }
 
 std::shared_ptr<ArmMotionProfile> ArmMotionProfileGenerator::generateProfile(std::shared_ptr<ArmPath> path)
 {
+	if (path->size() < 2)
+		throw std::runtime_error("a path needs at least two points");
+
+	global_left_ = globalBudget;
+
+	if (path->type() == ArmPath::Type::Joint)
+		return generateJointProfile(path);
+
+	const ArmPath::Tolerances& tolerances = path->tolerances();
+	std::shared_ptr<const ProfileCache> previous = path->cache();
+	auto cache = std::make_shared<ProfileCache>(arm_, tolerances);
+	bool reuse = (previous != nullptr && previous->sameSetup(*cache));
+
 	//
-	// Step 1: Generate a set of splines for this path
+	// Step 1: Generate a spline for each segment of the path and sample it closely enough that
+	//         the samples follow the spline within the tolerances for the path.  Solve for the
+	//         joint angles of the samples, continuing from the end of the segment before, add
+	//         samples where the joints move too far between them, and make the angles
+	//         continuous.  A segment whose waypoints have not moved, and whose solve started
+	//         from the same angles, comes out the same as last time, so it is taken from the
+	//         last run.  That makes the result the same as if nothing were reused.
 	//
-	auto splines = computeSplinesForPath(path);
+	QVector<double> prev;
+
+	for (int i = 0; i < path->size() - 1; i++) {
+		checkCancelled();
+
+		const Pose2d& p1 = path->at(i);
+		const Pose2d& p2 = path->at(i + 1);
+		const ProfileCache::Segment* old = reuse ? previous->find(i, p1, p2) : nullptr;
+
+		ProfileCache::Segment segment;
+		if (old != nullptr && old->seed == prev) {
+			segment = *old;
+		}
+		else {
+			segment = newSegment(p1, p2, (old != nullptr) ? old->spline : nullptr, prev, tolerances);
+		}
+
+		prev = segment.samples.back().angles();
+		cache->segments().push_back(segment);
+	}
 
 	//
-	// Step 2: Generate a discrete form of the path where the curvature, x, and y do not deviate
-	//         to an amount large enough to misrepresent the path for our purposes
+	// Step 2: Join all of the segments into one set of samples
 	//
-	double maxDx = 1.0;
-	double maxDy = 1.0;
-	double maxDTheta = 1.0;
-	QVector<Pose2dTrajectory> discrete = makeDiscrete(splines, maxDx, maxDy, maxDTheta);
+	checkCancelled();
+	QVector<double> distances;
+	QVector<Pose2dTrajectory> samples = joinSegments(cache->segments(), distances);
 
 	//
-	// Step 3: Generate a set of points that are an equal distance apart
+	// Step 3: Generate a timing view that meets the constraints of the system
 	// 
-	double diststep = 1.0;
-	QVector<Pose2dTrajectory> equidist = makeEqualDistance(discrete, diststep);
+	checkCancelled();
+	std::shared_ptr<const ToppRA> timing;
+	std::shared_ptr<ArmMotionProfile> profile = generateTimedProfile(path, samples, distances, (previous != nullptr) ? previous->timing() : nullptr, timing);
 
-	//
-	// Step 4: Generate a timing view that meets the constraints of the system
-	// 
-	std::shared_ptr<ArmMotionProfile> profile = generateTimedProfile(path, equidist);
+	cache->setTiming(timing);
+	path->setCache(cache);
 
 	return profile;
 }
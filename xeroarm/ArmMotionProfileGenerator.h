@@ -1,36 +1,83 @@
 #pragma once
 
-#include "ArmDataModel.h"
+#include "RobotArm.h"
 #include "ArmPath.h"
 #include "ArmMotionProfile.h"
-#include "Pose2dConstrained.h"
+#include "ProfileCache.h"
 #include <QtCore/QVector>
+#include <functional>
+#include <stdexcept>
 
 class SplinePair;
 
+//
+// Thrown out of the generator when the caller asks it to stop
+//
+class GenerationCancelled : public std::runtime_error
+{
+public:
+	GenerationCancelled() : std::runtime_error("generation cancelled") {
+	}
+};
+
 class ArmMotionProfileGenerator
 {
 public:
-	ArmMotionProfileGenerator(ArmDataModel &model);
+	//
+	// The generator only reads the arm, so it can run on a copy while the original is edited
+	//
+	ArmMotionProfileGenerator(const RobotArm& arm);
+
+	//
+	// The generator calls cancelled between stages and every so often inside the longer loops,
+	// and throws GenerationCancelled as soon as it returns true
+	//
+	ArmMotionProfileGenerator(const RobotArm& arm, std::function<bool()> cancelled);
 
 	std::shared_ptr<ArmMotionProfile> generateProfile(std::shared_ptr<ArmPath> path);
 
 private:
 
-	void getSegmentArc(std::shared_ptr<SplinePair> pair, QVector<Pose2dTrajectory>& results, double t0, double t1, double maxDx, double maxDy, double maxDTheta);
+	void checkCancelled() const;
+	QVector<double> globalSolve(const Translation2d& pt, const QVector<double>& seed);
+
+	static bool needsSplit(const Pose2d& left, const Pose2d& mid, const Pose2d& right, double arc, const ArmPath::Tolerances& tolerances);
+	void sampleSegment(ProfileCache::Segment& segment, const ArmPath::Tolerances& tolerances);
+	void refineSegment(ProfileCache::Segment& segment, const ArmPath::Tolerances& tolerances);
+	void solveSegment(ProfileCache::Segment& segment, const QVector<double>& prev, const ArmPath::Tolerances& tolerances);
+	ProfileCache::Segment newSegment(const Pose2d& p1, const Pose2d& p2, std::shared_ptr<SplinePair> spline, const QVector<double>& prev,
+		const ArmPath::Tolerances& tolerances);
+	static QVector<Pose2dTrajectory> joinSegments(const QVector<ProfileCache::Segment>& segments, QVector<double>& distances);
+	void trackBranches(QVector<Pose2dTrajectory>& points);
+	static double jointDistance(const QVector<double>& a, const QVector<double>& b);
+	static double jointTravel(const QVector<double>& a, const QVector<double>& b);
+	QVector<QVector<double>> solveWaypoints(std::shared_ptr<ArmPath> path);
+	std::shared_ptr<ArmMotionProfile> generateJointProfile(std::shared_ptr<ArmPath> path);
+	static void effectorMotion(QVector<Pose2dTrajectory>& points);
+	std::shared_ptr<ArmMotionProfile> generateTimedProfile(std::shared_ptr<ArmPath> path, const QVector<Pose2dTrajectory>& points,
+		const QVector<double>& distances, std::shared_ptr<const ToppRA> previous, std::shared_ptr<const ToppRA>& timing);
 
-	QVector<std::shared_ptr<SplinePair>>  computeSplinesForPath(std::shared_ptr<ArmPath> path);
-	QVector<Pose2dTrajectory> makeDiscrete(const QVector<std::shared_ptr<SplinePair>>& splines, double maxDx, double maxDy, double maxDTheta);
-	QVector<Pose2dTrajectory> makeEqualDistance(const QVector<Pose2dTrajectory>& points, double diststep);
-	std::shared_ptr<ArmMotionProfile> generateTimedProfile(std::shared_ptr<ArmPath> path, const QVector<Pose2dTrajectory>& points);
+private:
+	//
+	// A sample whose joints move further than this from the sample before it, in degrees, is
+	// solved again from the previous sample in case the solver changed branches
+	//
+	static constexpr const double branchJump = 10.0;
 
-	double jointConstrainedVelocity(int iter, Pose2dConstrained& state, const Pose2dConstrained& pred);
-	double computeOneJointConstraint(int iter, int which, const Pose2dConstrained& pred, double dist);
-	double computeOneJointConstraintVelLimited(int which, const Pose2dConstrained& pred, double dist, double accel);
+	//
+	// The shortest piece of a spline, in the spline parameter, that is split any further
+	//
+	static constexpr const double minParamStep = 1.0 / 1024.0;
 
-	void computeJointMetrics(Pose2dConstrained& state, const Pose2dConstrained& pred);
+	//
+	// The time, in seconds, each path may spend in the global search on the points the
+	// selected solver cannot reach
+	//
+	static constexpr const double globalBudget = 0.5;
 
 private:
-	ArmDataModel& model_;
+	const RobotArm& arm_;
+	std::function<bool()> cancelled_;
+	double global_left_;
 };
 
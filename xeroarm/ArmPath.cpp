@@ -9,6 +9,7 @@ QJsonObject ArmPath::toJson()
 	QJsonArray points;
 
 	obj[JsonFileKeywords::NameKeyword] = name_;
+	obj[JsonFileKeywords::PathTypeKeyword] = (type_ == Type::Joint) ? JsonFileKeywords::JointPathType : JsonFileKeywords::CartesianPathType;
 
 	for (int i = 0; i < points_.count(); i++) {
 		pt[JsonFileKeywords::XKeyword] = points_.at(i).getTranslation().getX();
@@ -18,13 +19,38 @@ QJsonObject ArmPath::toJson()
 	}
 
 	obj[JsonFileKeywords::PointsKeyword] = points;
+
+	QJsonObject tolerances;
+	tolerances[JsonFileKeywords::MaxStepKeyword] = tolerances_.maxStep;
+	tolerances[JsonFileKeywords::MinStepKeyword] = tolerances_.minStep;
+	tolerances[JsonFileKeywords::MaxDeviationKeyword] = tolerances_.maxDeviation;
+	tolerances[JsonFileKeywords::MaxHeadingKeyword] = tolerances_.maxHeading;
+	tolerances[JsonFileKeywords::MaxJointStepKeyword] = tolerances_.maxJointStep;
+	obj[JsonFileKeywords::TolerancesKeyword] = tolerances;
+
 	return obj;
 }
 
+bool ArmPath::parseTolerance(const QJsonObject& obj, const char* name, QString& error, double& value)
+{
+	if (!obj.contains(name))
+		return true;
+
+	if (!obj.value(name).isDouble() || obj.value(name).toDouble() <= 0.0) {
+		error = "json file contains member '" + QString(name) + "', but it is not a positive double";
+		return false;
+	}
+
+	value = obj.value(name).toDouble();
+	return true;
+}
+
 bool ArmPath::fromJson(const QJsonObject& obj, QString& error)
 {
 	name_.clear();
 	points_.clear();
+	type_ = Type::Cartesian;
+	tolerances_ = Tolerances();
 
 	if (!obj.contains(JsonFileKeywords::NameKeyword)) {
 		error = "json file does not contains '" + QString(JsonFileKeywords::NameKeyword) + "' member";
@@ -38,6 +64,21 @@ bool ArmPath::fromJson(const QJsonObject& obj, QString& error)
 
 	name_ = obj.value(JsonFileKeywords::NameKeyword).toString();
 
+	//
+	// Paths written before joint paths were added are all cartesian
+	//
+	if (obj.contains(JsonFileKeywords::PathTypeKeyword)) {
+		QString type = obj.value(JsonFileKeywords::PathTypeKeyword).toString();
+		if (type == JsonFileKeywords::JointPathType) {
+			type_ = Type::Joint;
+		}
+		else if (type != JsonFileKeywords::CartesianPathType) {
+			error = "json file contains member '" + QString(JsonFileKeywords::PathTypeKeyword) + "', but it is not '" +
+				JsonFileKeywords::CartesianPathType + "' or '" + JsonFileKeywords::JointPathType + "'";
+			return false;
+		}
+	}
+
 	if (!obj.contains(JsonFileKeywords::PointsKeyword)) {
 		error = "json file does not contains '" + QString(JsonFileKeywords::PointsKeyword) + "' member";
 		return false;
@@ -63,5 +104,24 @@ bool ArmPath::fromJson(const QJsonObject& obj, QString& error)
 		points_.push_back(pt);
 	}
 
+	//
+	// The tolerances are optional, files written before they were added use the defaults, as
+	// does any one left out
+	//
+	if (obj.contains(JsonFileKeywords::TolerancesKeyword)) {
+		if (!obj.value(JsonFileKeywords::TolerancesKeyword).isObject()) {
+			error = "json file contains member '" + QString(JsonFileKeywords::TolerancesKeyword) + "', but it is not a JSON object";
+			return false;
+		}
+
+		QJsonObject tolerances = obj.value(JsonFileKeywords::TolerancesKeyword).toObject();
+		if (!parseTolerance(tolerances, JsonFileKeywords::MaxStepKeyword, error, tolerances_.maxStep) ||
+			!parseTolerance(tolerances, JsonFileKeywords::MinStepKeyword, error, tolerances_.minStep) ||
+			!parseTolerance(tolerances, JsonFileKeywords::MaxDeviationKeyword, error, tolerances_.maxDeviation) ||
+			!parseTolerance(tolerances, JsonFileKeywords::MaxHeadingKeyword, error, tolerances_.maxHeading) ||
+			!parseTolerance(tolerances, JsonFileKeywords::MaxJointStepKeyword, error, tolerances_.maxJointStep))
+			return false;
+	}
+
 	return true;
 }
\ No newline at end of file
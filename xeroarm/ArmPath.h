@@ -8,16 +8,87 @@
 #include "ArmMotionProfile.h"
 #include "Pose2d.h"
 
+class ProfileCache;
+
 class ArmPath
 {
+public:
+	//
+	// A cartesian path moves the end effector along splines through the waypoints.  A joint
+	// path only visits the waypoints, moving the joints along splines between the joint angles
+	// at each, and the end effector goes wherever that takes it in between.
+	//
+	enum class Type
+	{
+		Cartesian,
+		Joint
+	};
+
+	//
+	// How closely the samples the generator takes along the path must follow it.  Samples are
+	// added until every one of these holds between each pair of neighboring samples, or the
+	// samples are as close together as they are allowed to be.
+	//
+	struct Tolerances
+	{
+		//
+		// The longest distance between samples
+		//
+		double maxStep = 4.0;
+
+		//
+		// The shortest distance between samples.  The timing pass takes the second derivative
+		// of the joint angles from neighboring samples, and closer than this the small errors
+		// in the solved angles swamp it and slow the profile down.
+		//
+		double minStep = 1.0;
+
+		//
+		// The furthest the path may stray from the straight line between samples
+		//
+		double maxDeviation = 0.05;
+
+		//
+		// The most the heading of the path may turn between samples, in degrees
+		//
+		double maxHeading = 5.0;
+
+		//
+		// How far the joints may move between samples, the length of the change in the joint
+		// angles, in degrees
+		//
+		double maxJointStep = 4.0;
+
+		bool operator==(const Tolerances& other) const {
+			return maxStep == other.maxStep && minStep == other.minStep && maxDeviation == other.maxDeviation && maxHeading == other.maxHeading && maxJointStep == other.maxJointStep;
+		}
+
+		bool operator!=(const Tolerances& other) const {
+			return !(*this == other);
+		}
+	};
+
 public:
 	ArmPath() {
+		type_ = Type::Cartesian;
 	}
 
 	ArmPath(const QString& name) {
 		name_ = name;
+		type_ = Type::Cartesian;
+	}
+
+	//
+	// A snapshot of the path for the generator.  The points are shared with the original
+	// until one of the two is edited.
+	//
+	ArmPath(const ArmPath& other) : name_(other.name_), type_(other.type_), points_(other.points_), tolerances_(other.tolerances_) {
+		profile_ = other.profile();
+		cache_ = other.cache();
 	}
 
+	ArmPath& operator=(const ArmPath& other) = delete;
+
 	void setName(const QString& name) {
 		name_ = name;
 	}
@@ -26,6 +97,14 @@ public:
 		return name_;
 	}
 
+	Type type() const {
+		return type_;
+	}
+
+	void setType(Type type) {
+		type_ = type;
+	}
+
 	void addPoint(const Pose2d& pt) {
 		points_.push_back(pt);
 	}
@@ -42,11 +121,11 @@ public:
 		return points_.size();
 	}
 
-	const Pose2d& at(int index) {
+	const Pose2d& at(int index) const {
 		return points_[index];
 	}
 
-	const Pose2d& operator[](int index) {
+	const Pose2d& operator[](int index) const {
 		return points_[index];
 	}
 
@@ -54,19 +133,50 @@ public:
 		points_[index] = pt;
 	}
 
+	const Tolerances& tolerances() const {
+		return tolerances_;
+	}
+
+	void setTolerances(const Tolerances& tolerances) {
+		tolerances_ = tolerances;
+	}
+
+	//
+	// The profile is published from the threads that generate paths and read from the UI, and
+	// is never changed once published.  Read it once and keep the pointer, two reads may return
+	// different profiles.
+	//
 	void setProfile(std::shared_ptr<ArmMotionProfile> profile) {
-		profile_ = profile;
+		std::atomic_store(&profile_, profile);
+	}
+
+	std::shared_ptr<ArmMotionProfile> profile() const {
+		return std::atomic_load(&profile_);
+	}
+
+	//
+	// What the generator kept from its last run over this path, so the next run only redoes
+	// the segments that changed.  Set from the threads that generate paths.
+	//
+	void setCache(std::shared_ptr<const ProfileCache> cache) {
+		std::atomic_store(&cache_, cache);
 	}
 
-	std::shared_ptr<ArmMotionProfile> profile() {
-		return profile_;
+	std::shared_ptr<const ProfileCache> cache() const {
+		return std::atomic_load(&cache_);
 	}
 
 	QJsonObject toJson();
 	bool fromJson(const QJsonObject& obj, QString &error);
 
+private:
+	static bool parseTolerance(const QJsonObject& obj, const char* name, QString& error, double& value);
+
 private:
 	QString name_;
+	Type type_;
 	QVector<Pose2d> points_;
+	Tolerances tolerances_;
 	std::shared_ptr<ArmMotionProfile> profile_;
+	std::shared_ptr<const ProfileCache> cache_;
 };
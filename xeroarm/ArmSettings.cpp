@@ -100,6 +100,15 @@ void ArmSettings::jointSettingChanged(int which, ChangeType type)
 	case ChangeType::MaxAccel:
 		dm.setMaxAccel(settings_[which]->maxAccel());
 		break;
+
+	case ChangeType::MaxJerk:
+		dm.setMaxJerk(settings_[which]->maxJerk());
+		break;
+
+	case ChangeType::JointLimits:
+		dm.setCWConstraint(settings_[which]->cwLimit());
+		dm.setCCWConstraint(settings_[which]->ccwLimit());
+		break;
 	}
 
 	model_.replaceJointModel(which, dm);
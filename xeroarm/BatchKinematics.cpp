@@ -0,0 +1,211 @@
+#include "BatchKinematics.h"
+#include "RobotArm.h"
+#include "MathUtils.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define BATCH_KINEMATICS_AVX2
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define AVX2_TARGET
+#else
+#define AVX2_TARGET __attribute__((target("avx2,fma")))
+#endif
+#endif
+
+BatchKinematics::BatchKinematics(const RobotArm& arm)
+{
+	for (int i = 0; i < arm.count(); i++) {
+		lengths_.push_back(arm.at(i).length());
+	}
+
+	base_x_ = arm.pos().getX();
+	base_y_ = arm.pos().getY();
+}
+
+bool BatchKinematics::hasAVX2()
+{
+#ifdef BATCH_KINEMATICS_AVX2
+	static const bool supported = []() {
+#if defined(_MSC_VER)
+		int info[4];
+
+		//
+		// The processor must have AVX and FMA, and the operating system must save the
+		// upper halves of the YMM registers on a context switch, before AVX2 means anything
+		//
+		__cpuid(info, 1);
+		const bool fma = (info[2] & (1 << 12)) != 0;
+		const bool osxsave = (info[2] & (1 << 27)) != 0;
+		const bool avx = (info[2] & (1 << 28)) != 0;
+		if (!fma || !osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6)
+			return false;
+
+		__cpuidex(info, 7, 0);
+		return (info[1] & (1 << 5)) != 0;
+#else
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+	}();
+
+	return supported;
+#else
+	return false;
+#endif
+}
+
+#ifdef BATCH_KINEMATICS_AVX2
+
+//
+// Sine and cosine of four angles in degrees.  The angle is reduced to within 45 degrees of a
+// multiple of 90 while still in degrees, where the subtraction is exact, and only the remainder
+// is converted to radians.  The remainder goes through the minimax polynomials from the Cephes
+// library, which are good to about one unit in the last place over that range, and the quadrant
+// picks which of the two is the sine and what the signs are.
+//
+static inline AVX2_TARGET void sinCosDegrees(__m256d degrees, __m256d& sine, __m256d& cosine)
+{
+	const __m256d quadrant = _mm256_round_pd(_mm256_mul_pd(degrees, _mm256_set1_pd(1.0 / 90.0)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+	const __m256d x = _mm256_mul_pd(_mm256_fnmadd_pd(quadrant, _mm256_set1_pd(90.0), degrees), _mm256_set1_pd(MathUtils::kPI / 180.0));
+	const __m256d z = _mm256_mul_pd(x, x);
+
+	__m256d sp = _mm256_set1_pd(1.58962301576546568060E-10);
+	sp = _mm256_fmadd_pd(sp, z, _mm256_set1_pd(-2.50507477628578072866E-8));
+	sp = _mm256_fmadd_pd(sp, z, _mm256_set1_pd(2.75573136213857245213E-6));
+	sp = _mm256_fmadd_pd(sp, z, _mm256_set1_pd(-1.98412698295895385996E-4));
+	sp = _mm256_fmadd_pd(sp, z, _mm256_set1_pd(8.33333333332211858878E-3));
+	sp = _mm256_fmadd_pd(sp, z, _mm256_set1_pd(-1.66666666666666307295E-1));
+	const __m256d s = _mm256_fmadd_pd(_mm256_mul_pd(x, z), sp, x);
+
+	__m256d cp = _mm256_set1_pd(-1.13585365213876817300E-11);
+	cp = _mm256_fmadd_pd(cp, z, _mm256_set1_pd(2.08757008419747316778E-9));
+	cp = _mm256_fmadd_pd(cp, z, _mm256_set1_pd(-2.75573141792967388112E-7));
+	cp = _mm256_fmadd_pd(cp, z, _mm256_set1_pd(2.48015872888517045348E-5));
+	cp = _mm256_fmadd_pd(cp, z, _mm256_set1_pd(-1.38888888888730564116E-3));
+	cp = _mm256_fmadd_pd(cp, z, _mm256_set1_pd(4.16666666666665929218E-2));
+	const __m256d c = _mm256_fmadd_pd(_mm256_mul_pd(z, z), cp, _mm256_fnmadd_pd(_mm256_set1_pd(0.5), z, _mm256_set1_pd(1.0)));
+
+	//
+	// Odd quadrants swap sine and cosine.  The sine is negated in quadrants two and three and
+	// the cosine in quadrants one and two, which is bit one of the quadrant and of the quadrant
+	// plus one, moved up to the sign bit.
+	//
+	const __m256i q = _mm256_cvtepi32_epi64(_mm256_cvtpd_epi32(quadrant));
+	const __m256i one = _mm256_set1_epi64x(1);
+	const __m256i two = _mm256_set1_epi64x(2);
+	const __m256d swap = _mm256_castsi256_pd(_mm256_cmpeq_epi64(_mm256_and_si256(q, one), one));
+	const __m256d sinsign = _mm256_castsi256_pd(_mm256_slli_epi64(_mm256_and_si256(q, two), 62));
+	const __m256d cossign = _mm256_castsi256_pd(_mm256_slli_epi64(_mm256_and_si256(_mm256_add_epi64(q, one), two), 62));
+
+	sine = _mm256_xor_pd(_mm256_blendv_pd(s, c, swap), sinsign);
+	cosine = _mm256_xor_pd(_mm256_blendv_pd(c, s, swap), cossign);
+}
+
+//
+// Four configurations at a time, each joint loaded for all four with one read from its row.
+// Returns the first configuration it did not get to, leaving fewer than four for scalar code.
+//
+static AVX2_TARGET int forwardAVX2(const double* angles, int stride, const QVector<double>& lengths, double basex, double basey, double* x, double* y, int first, int last)
+{
+	int i = first;
+
+	for (; i + 4 <= last; i += 4) {
+		__m256d heading = _mm256_setzero_pd();
+		__m256d px = _mm256_set1_pd(basex);
+		__m256d py = _mm256_set1_pd(basey);
+
+		for (int j = 0; j < lengths.count(); j++) {
+			__m256d sine, cosine;
+
+			heading = _mm256_add_pd(heading, _mm256_loadu_pd(angles + static_cast<size_t>(j) * stride + i));
+			sinCosDegrees(heading, sine, cosine);
+
+			const __m256d length = _mm256_set1_pd(lengths[j]);
+			px = _mm256_fmadd_pd(cosine, length, px);
+			py = _mm256_fmadd_pd(sine, length, py);
+		}
+
+		_mm256_storeu_pd(x + i, px);
+		_mm256_storeu_pd(y + i, py);
+	}
+
+	return i;
+}
+
+#endif
+
+void BatchKinematics::forwardRange(const AngleSet& angles, PositionSet& positions, Kernel kernel, int first, int last) const
+{
+	const int stride = static_cast<int>(angles.cols());
+	const double* data = angles.data();
+	double* x = positions.data();
+	double* y = positions.data() + positions.cols();
+
+#ifdef BATCH_KINEMATICS_AVX2
+	if (kernel == Kernel::AVX2 && hasAVX2())
+		first = forwardAVX2(data, stride, lengths_, base_x_, base_y_, x, y, first, last);
+#endif
+
+	if (first >= last)
+		return;
+
+	//
+	// Work a joint at a time across the configurations, so the angles are read in order
+	//
+	std::vector<double> heading(last - first, 0.0);
+	std::fill(x + first, x + last, base_x_);
+	std::fill(y + first, y + last, base_y_);
+
+	for (int j = 0; j < lengths_.count(); j++) {
+		const double* row = data + static_cast<size_t>(j) * stride;
+		const double length = lengths_[j];
+
+		for (int i = first; i < last; i++) {
+			double& h = heading[i - first];
+			h += row[i];
+
+			double rad = MathUtils::degreesToRadians(h);
+			x[i] += std::cos(rad) * length;
+			y[i] += std::sin(rad) * length;
+		}
+	}
+}
+
+BatchKinematics::PositionSet BatchKinematics::forwardKinematics(const AngleSet& angles) const
+{
+	return forwardKinematics(angles, bestKernel(), true);
+}
+
+BatchKinematics::PositionSet BatchKinematics::forwardKinematics(const AngleSet& angles, Kernel kernel, bool parallel) const
+{
+	assert(angles.rows() == count());
+
+	const int total = static_cast<int>(angles.cols());
+	PositionSet ret(2, total);
+
+	if (!parallel) {
+		forwardRange(angles, ret, kernel, 0, total);
+		return ret;
+	}
+
+	//
+	// Keep the chunk boundaries on multiples of four so only the last chunk has a scalar tail
+	//
+	ThreadPool& pool = ThreadPool::global();
+	int chunks = std::max(1, std::min(pool.threadCount(), total / minParallelChunk));
+	int blocks = (total + 3) / 4;
+
+	pool.parallelFor(chunks, [&](int chunk) {
+		int first = static_cast<int>(static_cast<long long>(blocks) * chunk / chunks) * 4;
+		int last = std::min(total, static_cast<int>(static_cast<long long>(blocks) * (chunk + 1) / chunks) * 4);
+		forwardRange(angles, ret, kernel, first, last);
+	});
+
+	return ret;
+}
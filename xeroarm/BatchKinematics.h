@@ -0,0 +1,71 @@
+#pragma once
+
+#include <Eigen/Dense>
+#include <QtCore/QVector>
+
+class RobotArm;
+
+//
+// Forward kinematics for many joint configurations in one call.  The angles are laid out
+// structure of arrays style, a row per joint and a column per configuration, with each row
+// contiguous in memory so the kernel can load the same joint for four configurations at once.
+// Angles are in degrees, relative to the previous link, the same as RobotArm.
+//
+// The arm is copied when the object is built, so later changes to the arm are not seen and
+// the object can be used from any thread.
+//
+class BatchKinematics
+{
+public:
+	typedef Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> AngleSet;
+	typedef Eigen::Matrix<double, 2, Eigen::Dynamic, Eigen::RowMajor> PositionSet;
+
+	//
+	// Scalar works everywhere.  AVX2 computes four configurations at a time, with the sines
+	// and cosines from a polynomial, and needs a processor with AVX2 and FMA.
+	//
+	enum class Kernel
+	{
+		Scalar,
+		AVX2,
+	};
+
+public:
+	BatchKinematics(const RobotArm& arm);
+
+	int count() const {
+		return lengths_.count();
+	}
+
+	//
+	// The end effector position for every column of angles, using the best kernel for this
+	// processor spread across the global thread pool
+	//
+	PositionSet forwardKinematics(const AngleSet& angles) const;
+
+	//
+	// The same, with the kernel chosen by the caller, and on the calling thread alone unless
+	// parallel is true.  Asking for AVX2 on a processor without it falls back to scalar code.
+	//
+	PositionSet forwardKinematics(const AngleSet& angles, Kernel kernel, bool parallel) const;
+
+	static bool hasAVX2();
+
+	static Kernel bestKernel() {
+		return hasAVX2() ? Kernel::AVX2 : Kernel::Scalar;
+	}
+
+private:
+	void forwardRange(const AngleSet& angles, PositionSet& positions, Kernel kernel, int first, int last) const;
+
+private:
+	//
+	// Below this many configurations per chunk, the cost of handing out the work outweighs the gain
+	//
+	static constexpr const int minParallelChunk = 4096;
+
+private:
+	QVector<double> lengths_;
+	double base_x_;
+	double base_y_;
+};
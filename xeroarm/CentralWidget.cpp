@@ -37,11 +37,15 @@ CentralWidget::~CentralWidget()
 
 void CentralWidget::timeChanged(int ms)
 {
-	if (path_ == nullptr || path_->profile() == nullptr)
+	if (path_ == nullptr)
+		return;
+
+	auto prof = path_->profile();
+	if (prof == nullptr)
 		return;
 
 	double t = static_cast<double>(ms) / 100.0;
-	Pose2dTrajectory pt = path_->profile()->getByTime(t);
+	Pose2dTrajectory pt = prof->getByTime(t);
 	model_.blockSignals(true);
 	for (int i = 0; i < model_.jointCount(); i++) {
 		if (i == model_.jointCount() - 1) {
@@ -57,9 +61,10 @@ void CentralWidget::pathSelected(std::shared_ptr<ArmPath> path)
 {
 	path_ = path;
 	display_->setCurrentPath(path);
+	model_.setSelectedPath(path);
 
-	if (path_ != nullptr && path_->profile() != nullptr) {
-		auto prof = path_->profile();
+	auto prof = (path_ != nullptr) ? path_->profile() : nullptr;
+	if (prof != nullptr) {
 		slider_->setMaximum(static_cast<int>(prof->time() * 100));
 	}
 	slider_->setValue(0);
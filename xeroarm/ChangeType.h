@@ -9,6 +9,8 @@ enum class ChangeType
 	ArmLength,
 	MaxVelocity,
 	MaxAccel,
+	MaxJerk,
+	JointLimits,
 	BumperPos,
 	BumperSize,
 	ArmPos,
@@ -16,5 +18,6 @@ enum class ChangeType
 	AddPath,
 	RemovePath,
 	RenamePath,
+	PathType,
 	PathPoint
 };
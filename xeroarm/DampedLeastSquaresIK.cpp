@@ -0,0 +1,103 @@
+#include "DampedLeastSquaresIK.h"
+#include "RobotArm.h"
+#include "MathUtils.h"
+#include <cmath>
+
+using Eigen::MatrixXd;
+using Eigen::Matrix2d;
+using Eigen::Vector2d;
+
+DampedLeastSquaresIK::DampedLeastSquaresIK(const RobotArm& arm) : JacobianIK(arm)
+{
+}
+
+QVector<double> DampedLeastSquaresIK::dampedStep(const QVector<double>& current, const MatrixXd& jacobian, const Translation2d& error, double lambda) const
+{
+	//
+	// J J^T is only 2x2, so solving the damped system is cheap
+	//
+	Matrix2d jjt = jacobian * jacobian.transpose();
+	jjt(0, 0) += lambda * lambda;
+	jjt(1, 1) += lambda * lambda;
+
+	Vector2d e(error.getX(), error.getY());
+	Vector2d y = jjt.ldlt().solve(e);
+	Eigen::VectorXd dt = jacobian.transpose() * y;
+	IKTuning::limitStep(dt);
+
+	QVector<double> ret(current.count());
+	for (int i = 0; i < current.count(); i++) {
+		ret[i] = MathUtils::boundDegrees(current[i] + dt(i));
+	}
+
+	return ret;
+}
+
+QVector<double> DampedLeastSquaresIK::inverseKinematics(const Translation2d& pt) const
+{
+	IKStats stats;
+	return inverseKinematics(pt, initialAngles(), stats);
+}
+
+QVector<double> DampedLeastSquaresIK::inverseKinematics(const Translation2d& pt, const QVector<double>& seed) const
+{
+	IKStats stats;
+	return inverseKinematics(pt, seed, stats);
+}
+
+QVector<double> DampedLeastSquaresIK::inverseKinematicsAlongPath(const Translation2d& pt, const QVector<double>& prev) const
+{
+	//
+	// The damped step from the previous solution is already a good prediction, so there is
+	// nothing to gain from a separate predictor
+	//
+	return inverseKinematics(pt, prev);
+}
+
+QVector<double> DampedLeastSquaresIK::inverseKinematics(const Translation2d& pt, const QVector<double>& seed, IKStats& stats) const
+{
+	stats = IKStats();
+
+	QVector<double> current = (seed.count() == arm_.count()) ? seed : initialAngles();
+	Translation2d curpos = arm_.forwardKinematics(current);
+	double dist = curpos.distance(pt);
+	double lambda = IKTuning::initialDamping;
+
+	while (dist > IKTuning::arrivedThreshold && stats.iterations < IKTuning::maxDampedIterations && lambda < IKTuning::maxDamping)
+	{
+		stats.iterations++;
+
+		//
+		// Backtracking, halve the error we ask for until the step actually gets us closer.  The
+		// arm has not moved while backing off, so the Jacobian is the same for every trial.
+		//
+		MatrixXd jacobian = computeJacobian(current);
+		Translation2d error = pt - curpos;
+		bool accepted = false;
+		for (int i = 0; i <= IKTuning::maxBacktracks && !accepted; i++) {
+			QVector<double> next = dampedStep(current, jacobian, error, lambda);
+			Translation2d nextpos = arm_.forwardKinematics(next);
+			double nextdist = nextpos.distance(pt);
+
+			if (nextdist < dist) {
+				current = next;
+				curpos = nextpos;
+				dist = nextdist;
+				accepted = true;
+			}
+			else {
+				error = error * 0.5;
+			}
+		}
+
+		lambda = IKTuning::nextDamping(lambda, accepted);
+	}
+
+	stats.error = dist;
+	stats.converged = (dist <= IKTuning::arrivedThreshold);
+
+	if (!stats.converged)
+		current.clear();
+
+	return current;
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "JacobianIK.h"
+
+class RobotArm;
+
+//
+// Levenberg-Marquardt style inverse kinematics.  Each step solves the damped normal equations
+//
+//    dtheta = J^T (J J^T + lambda^2 I)^-1 e
+//
+// which stays well behaved when the arm is near a singular configuration (fully stretched or
+// folded) where the plain pseudo inverse takes huge steps.  The damping shrinks while steps are
+// reducing the error and grows when they are not, and each step is backed off until it makes
+// progress.  The number of iterations is small and fixed, so the worst case time is bounded.
+//
+class DampedLeastSquaresIK : public JacobianIK
+{
+public:
+	DampedLeastSquaresIK(const RobotArm& arm);
+
+	QVector<double> inverseKinematics(const Translation2d& pt) const;
+	QVector<double> inverseKinematics(const Translation2d& pt, const QVector<double>& seed) const;
+	QVector<double> inverseKinematics(const Translation2d& pt, const QVector<double>& seed, IKStats& stats) const;
+	QVector<double> inverseKinematicsAlongPath(const Translation2d& pt, const QVector<double>& prev) const;
+
+private:
+	QVector<double> dampedStep(const QVector<double>& current, const Eigen::MatrixXd& jacobian, const Translation2d& error, double lambda) const;
+};
@@ -23,6 +23,22 @@ public:
 		return length_;
 	}
 
+	const Translation2d& start() const {
+		return start_;
+	}
+
+	const Translation2d& end() const {
+		return end_;
+	}
+
+	void setStart(const Translation2d& start) {
+		start_ = start;
+	}
+
+	void setEnd(const Translation2d& end) {
+		end_ = end;
+	}
+
 	Translation2d getDirectionUV() const {
 		return (end_ - start_).normal();
 	}
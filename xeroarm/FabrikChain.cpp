@@ -1,31 +1,134 @@
 #include "FabrikChain.h"
+#include "MathUtils.h"
+#include <cmath>
 
 FabrikChain::FabrikChain()
 {
+	iterations_ = 0;
 }
 
-bool FabrikChain::solveIK(const Translation2d& target)
+Rotation2d FabrikChain::constrain(const Rotation2d& dir, const Rotation2d& ref, double cw, double ccw)
 {
 	//
-	// Loop from end bone back to the base of the arm
+	// The angle of dir measured from ref, positive is counter clockwise
 	//
-	for (int loop = bones_.count() - 1; loop >= 0; loop--) 
+	double angle = ref.inverse().rotateBy(dir).toDegrees();
+
+	if (angle > ccw)
+		return ref.rotateBy(Rotation2d::fromDegrees(ccw));
+
+	if (angle < -cw)
+		return ref.rotateBy(Rotation2d::fromDegrees(-cw));
+
+	return dir;
+}
+
+void FabrikChain::backwardPass(const Translation2d& target)
+{
+	//
+	// Loop from end bone back to the base of the arm, pinning the end of the last bone
+	// to the target and dragging each bone inward along its current direction
+	//
+	Translation2d end = target;
+	Rotation2d outerdir;
+
+	for (int loop = bones_.count() - 1; loop >= 0; loop--)
 	{
-		const FabrikBone& bone = bones_.at(loop);
-		double length = bone.length();
+		FabrikBone& bone = bones_[loop];
+		Rotation2d dir = Translation2d(bone.start(), end).direction();
 
 		if (loop != bones_.count() - 1)
 		{
-			const FabrikBone& outerBone = bones_.at(loop + 1);
-			Translation2d outerBoneOutgerToInnerUV = outerBone.getDirectionUV().inverse();
-			Translation2d thisBoneOuterToInnerUV = bone.getDirectionUV().inverse();
-
+			//
+			// The joint at the outer end of this bone limits how far this bone may turn away
+			// from the outer bone.  Seen from the outer bone the limits are mirrored.
+			//
+			const FabrikJoint& outer = joints_.at(loop + 1);
+			if (outer.coordSystem() == FabrikJoint::ConstraintCoordinateSystem::LOCAL)
+				dir = constrain(dir, outerdir, outer.counterClockWise(), outer.clockWise());
 		}
+
+		const FabrikJoint& joint = joints_.at(loop);
+		if (joint.coordSystem() == FabrikJoint::ConstraintCoordinateSystem::GLOBAL)
+			dir = constrain(dir, Rotation2d(), joint.clockWise(), joint.counterClockWise());
+
+		bone.setEnd(end);
+		bone.setStart(end - Translation2d(dir, bone.length()));
+
+		end = bone.start();
+		outerdir = dir;
+	}
+}
+
+void FabrikChain::forwardPass(const Translation2d& base)
+{
+	//
+	// Loop from the base of the arm out to the end bone, pinning the start of the first
+	// bone to the base and dragging each bone outward along its current direction
+	//
+	Translation2d start = base;
+	Rotation2d innerdir;
+
+	for (int loop = 0; loop < bones_.count(); loop++)
+	{
+		FabrikBone& bone = bones_[loop];
+		const FabrikJoint& joint = joints_.at(loop);
+		Rotation2d dir = Translation2d(start, bone.end()).direction();
+
+		if (joint.coordSystem() == FabrikJoint::ConstraintCoordinateSystem::LOCAL)
+			dir = constrain(dir, innerdir, joint.clockWise(), joint.counterClockWise());
 		else
-		{
+			dir = constrain(dir, Rotation2d(), joint.clockWise(), joint.counterClockWise());
 
-		}
+		bone.setStart(start);
+		bone.setEnd(start + Translation2d(dir, bone.length()));
+
+		start = bone.end();
+		innerdir = dir;
+	}
+}
+
+bool FabrikChain::solveIK(const Translation2d& target)
+{
+	iterations_ = 0;
+
+	if (bones_.isEmpty())
+		return false;
+
+	const Translation2d base = bones_.front().start();
+	double dist = effector().distance(target);
+
+	for (int iter = 0; iter < maxIterations && dist > arrivedThreshold; iter++)
+	{
+		backwardPass(target);
+		forwardPass(base);
+		iterations_++;
+
+		//
+		// Stop when the chain has stalled, either the target is out of reach or the
+		// constraints keep the effector from getting any closer
+		//
+		double newdist = effector().distance(target);
+		if (std::fabs(dist - newdist) < minImprovement && newdist > arrivedThreshold)
+			return false;
+
+		dist = newdist;
+	}
+
+	return dist <= arrivedThreshold;
+}
+
+QVector<double> FabrikChain::jointAngles() const
+{
+	QVector<double> ret;
+	Rotation2d innerdir;
+
+	for (const FabrikBone& bone : bones_)
+	{
+		Rotation2d dir = Translation2d(bone.start(), bone.end()).direction();
+		ret.push_back(innerdir.inverse().rotateBy(dir).toDegrees());
+		innerdir = dir;
 	}
 
-	return false;
+	return ret;
 }
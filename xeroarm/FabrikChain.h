@@ -2,6 +2,7 @@
 
 #include "FabrikBone.h"
 #include "FabrikJoint.h"
+#include "Rotation2d.h"
 #include <QtCore/QVector>
 
 class FabrikChain
@@ -16,15 +17,60 @@ public:
 
 	bool solveIK(const Translation2d& target);
 
+	//
+	// The number of backward and forward pass pairs the last solve took
+	//
+	int iterations() const {
+		return iterations_;
+	}
+
 	void add(const FabrikJoint& j, const FabrikBone& b) {
 		joints_.push_back(j);
 		bones_.push_back(b);
 	}
 
+	int count() const {
+		return bones_.count();
+	}
+
+	const FabrikBone& bone(int which) const {
+		return bones_.at(which);
+	}
+
+	const FabrikJoint& joint(int which) const {
+		return joints_.at(which);
+	}
+
+	//
+	// Where the last bone ends, or the origin for a chain with no bones
+	//
+	Translation2d effector() const {
+		if (bones_.isEmpty())
+			return Translation2d();
+
+		return bones_.back().end();
+	}
+
+	//
+	// The angle of each joint, in degrees, relative to the bone before it.  The first
+	// joint is relative to the X axis.
+	//
+	QVector<double> jointAngles() const;
+
+private:
+	void backwardPass(const Translation2d& target);
+	void forwardPass(const Translation2d& base);
+
+	static Rotation2d constrain(const Rotation2d& dir, const Rotation2d& ref, double cw, double ccw);
+
 private:
+	static constexpr const double arrivedThreshold = 0.1;
+	static constexpr const double minImprovement = 1.0e-6;
+	static constexpr const int maxIterations = 1000;
 
 private:
 	QVector<FabrikJoint> joints_;
 	QVector<FabrikBone> bones_;
+	int iterations_;
 };
 
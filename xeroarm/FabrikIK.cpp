@@ -1,37 +1,76 @@
 #include "FabrikIK.h"
 #include "RobotArm.h"
 
-FabrikIK::FabrikIK(const RobotArm& arm) : arm_(arm)
+FabrikIK::FabrikIK(const RobotArm& arm) : InverseKinematics(arm)
 {
 
 }
 
-FabrikChain *FabrikIK::buildChain() const
+FabrikChain FabrikIK::buildChain(const QVector<double>& angles) const
 {
-	FabrikChain* chain = new FabrikChain();
+	FabrikChain chain;
 
-	Translation2d start(arm_.pos());
-	Translation2d end;
-	QVector<double> angles = arm_.angles();
+	QVector<Pose2d> frames = arm_.jointFrames(angles);
 
 	for (int i = 0; i < arm_.count(); i++)
 	{
-		end = arm_.jointStartPos(i, angles);
-		FabrikJoint joint;
+		const JointDataModel& model = arm_.at(i);
+		FabrikJoint joint(FabrikJoint::ConstraintCoordinateSystem::LOCAL, model.cwConstraint(), model.ccwConstraint());
 
-		FabrikBone bone(start, end);
-		chain->add(joint, bone);
-
-		start = end;
+		FabrikBone bone(frames[i].getTranslation(), frames[i + 1].getTranslation());
+		chain.add(joint, bone);
 	}
 
 	return chain;
 }
 
+QVector<double> FabrikIK::initialAngles() const
+{
+	QVector<double> angles;
+	for (int i = 0; i < arm_.count(); i++) {
+		angles.push_back(arm_.at(i).initialAngle());
+	}
+
+	return angles;
+}
+
+bool FabrikIK::supportsArm() const
+{
+	return arm_.count() > 0;
+}
+
 QVector<double> FabrikIK::inverseKinematics(const Translation2d& pt) const
+{
+	return inverseKinematics(pt, initialAngles());
+}
+
+QVector<double> FabrikIK::inverseKinematics(const Translation2d& pt, const QVector<double>& seed) const
+{
+	IKStats stats;
+	return inverseKinematics(pt, seed, stats);
+}
+
+QVector<double> FabrikIK::inverseKinematics(const Translation2d& pt, const QVector<double>& seed, IKStats& stats) const
 {
 	QVector<double> ret;
-	FabrikChain* chain = buildChain();
+
+	if (!supportsArm()) {
+		stats = IKStats();
+		return ret;
+	}
+
+	if (seed.count() != arm_.count())
+		return inverseKinematics(pt, initialAngles(), stats);
+
+	stats = IKStats();
+
+	FabrikChain chain = buildChain(seed);
+	stats.converged = chain.solveIK(pt);
+	stats.iterations = chain.iterations();
+	stats.error = chain.effector().distance(pt);
+
+	if (stats.converged)
+		ret = chain.jointAngles();
 
 	return ret;
 }
@@ -10,11 +10,16 @@ class FabrikIK : public InverseKinematics
 public:
 	FabrikIK(const RobotArm& arm);
 	virtual QVector<double> inverseKinematics(const Translation2d& pt) const ;
+	virtual QVector<double> inverseKinematics(const Translation2d& pt, const QVector<double>& seed) const;
+	virtual QVector<double> inverseKinematics(const Translation2d& pt, const QVector<double>& seed, IKStats& stats) const;
 
-private:
-	FabrikChain *buildChain() const ;
+	//
+	// A chain needs at least one bone
+	//
+	bool supportsArm() const;
 
 private:
-	const RobotArm& arm_;
+	FabrikChain buildChain(const QVector<double>& angles) const ;
+	QVector<double> initialAngles() const;
 };
 
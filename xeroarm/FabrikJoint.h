@@ -7,11 +7,16 @@ public:
 		GLOBAL 
 	};
 
+	//
+	// A constraint of this many degrees in both directions leaves the joint free to rotate
+	//
+	static constexpr const double Unconstrained = 180.0;
+
 public:
 	FabrikJoint() {
-		cord_sys_ = ConstraintCoordinateSystem::GLOBAL;
-		clock_wise_constraint_ = 0.0;
-		counter_clock_wise_constraint_ = 0.0;
+		cord_sys_ = ConstraintCoordinateSystem::LOCAL;
+		clock_wise_constraint_ = Unconstrained;
+		counter_clock_wise_constraint_ = Unconstrained;
 	}
 
 	FabrikJoint(ConstraintCoordinateSystem coord, double clock, double counter) {
@@ -43,4 +48,3 @@ private:
 	double clock_wise_constraint_;
 	double counter_clock_wise_constraint_;
 };
-
@@ -0,0 +1,125 @@
+#pragma once
+
+#include "MathUtils.h"
+#include <Eigen/Dense>
+#include <cmath>
+#include <algorithm>
+#include <limits>
+
+//
+// Kinematics of a planar chain with the number of joints known at compile time.  Every
+// matrix and vector has a fixed size, so they live on the stack and the solvers built on
+// these kernels never touch the heap while iterating.  Angles are in degrees, relative to
+// the previous link, with joint zero relative to the X axis, the same as RobotArm.
+//
+template<int N, typename Scalar = double>
+class FixedKinematics
+{
+public:
+	using Angles = Eigen::Matrix<Scalar, N, 1>;
+	using Lengths = Eigen::Matrix<Scalar, N, 1>;
+	using Position = Eigen::Matrix<Scalar, 2, 1>;
+	using Jacobian = Eigen::Matrix<Scalar, 2, N>;
+
+public:
+	FixedKinematics(const Lengths& lengths, const Position& base) : lengths_(lengths), base_(base) {
+	}
+
+	const Lengths& lengths() const {
+		return lengths_;
+	}
+
+	const Position& base() const {
+		return base_;
+	}
+
+	Position forward(const Angles& angles) const {
+		Position ret = base_;
+		Scalar phi = Scalar(0);
+
+		for (int i = 0; i < N; i++) {
+			phi += angles(i) * degrees_;
+			ret(0) += std::cos(phi) * lengths_(i);
+			ret(1) += std::sin(phi) * lengths_(i);
+		}
+
+		return ret;
+	}
+
+	//
+	// Computes the end effector position and the analytic Jacobian, in units per degree, from
+	// the same pass down the chain
+	//
+	Position jacobian(const Angles& angles, Jacobian& jac) const {
+		Position ret = base_;
+		Scalar phi = Scalar(0);
+
+		for (int i = 0; i < N; i++) {
+			phi += angles(i) * degrees_;
+			Scalar c = std::cos(phi) * lengths_(i);
+			Scalar s = std::sin(phi) * lengths_(i);
+
+			ret(0) += c;
+			ret(1) += s;
+			jac(0, i) = -s;
+			jac(1, i) = c;
+		}
+
+		Scalar dx = Scalar(0);
+		Scalar dy = Scalar(0);
+		for (int i = N - 1; i >= 0; i--) {
+			dx += jac(0, i);
+			dy += jac(1, i);
+			jac(0, i) = dx * degrees_;
+			jac(1, i) = dy * degrees_;
+		}
+
+		return ret;
+	}
+
+	//
+	// Solves J^T (J J^T + lambda^2 I)^-1 e.  J J^T is 2x2 so its inverse is written out.  When
+	// the undamped system is singular the Jacobian has rank one and its pseudo inverse is
+	// J^T / trace(J J^T), which is what the minimum norm solution reduces to.
+	//
+	static Angles step(const Jacobian& jac, const Position& error, Scalar lambda = Scalar(0)) {
+		Scalar damping = lambda * lambda;
+		Scalar a = jac.row(0).squaredNorm() + damping;
+		Scalar b = jac.row(0).dot(jac.row(1));
+		Scalar c = jac.row(1).squaredNorm() + damping;
+		Scalar det = a * c - b * b;
+		Scalar trace = a + c;
+
+		if (trace <= Scalar(0))
+			return Angles::Zero();
+
+		Position y;
+		if (det <= singular_ * trace * trace) {
+			y = error / trace;
+		}
+		else {
+			y(0) = (c * error(0) - b * error(1)) / det;
+			y(1) = (a * error(1) - b * error(0)) / det;
+		}
+
+		return jac.transpose() * y;
+	}
+
+	static Scalar boundDegrees(Scalar d) {
+		return static_cast<Scalar>(MathUtils::boundDegrees(static_cast<double>(d)));
+	}
+
+	static void advance(Angles& angles, const Angles& delta) {
+		for (int i = 0; i < N; i++) {
+			angles(i) = boundDegrees(angles(i) + delta(i));
+		}
+	}
+
+private:
+	static constexpr const Scalar degrees_ = static_cast<Scalar>(MathUtils::kPI / 180.0);
+	static constexpr const Scalar singular_ = std::numeric_limits<Scalar>::epsilon();
+
+private:
+	Lengths lengths_;
+	Position base_;
+};
@@ -0,0 +1,279 @@
+#include "FixedKinematicsIK.h"
+#include "RobotArm.h"
+#include "MathUtils.h"
+#include <cmath>
+
+template<int N>
+FixedKinematicsIK<N>::FixedKinematicsIK(const RobotArm& arm, Method method) : InverseKinematics(arm)
+{
+	method_ = method;
+}
+
+template<int N>
+typename FixedKinematicsIK<N>::Kinematics FixedKinematicsIK<N>::kinematics() const
+{
+	//
+	// The joints can be edited between solves, so the lengths are read each time
+	//
+	typename Kinematics::Lengths lengths;
+	for (int i = 0; i < N; i++) {
+		lengths(i) = arm_.at(i).length();
+	}
+
+	return Kinematics(lengths, Position(arm_.pos().getX(), arm_.pos().getY()));
+}
+
+template<int N>
+typename FixedKinematicsIK<N>::Angles FixedKinematicsIK<N>::initialAngles() const
+{
+	Angles ret;
+	for (int i = 0; i < N; i++) {
+		ret(i) = arm_.at(i).initialAngle();
+	}
+
+	return ret;
+}
+
+template<int N>
+typename FixedKinematicsIK<N>::Angles FixedKinematicsIK<N>::toAngles(const QVector<double>& angles) const
+{
+	if (angles.count() != N)
+		return initialAngles();
+
+	Angles ret;
+	for (int i = 0; i < N; i++) {
+		ret(i) = angles[i];
+	}
+
+	return ret;
+}
+
+template<int N>
+QVector<double> FixedKinematicsIK<N>::fromAngles(const Angles& angles) const
+{
+	QVector<double> ret(N);
+	for (int i = 0; i < N; i++) {
+		ret[i] = angles(i);
+	}
+
+	return ret;
+}
+
+template<int N>
+bool FixedKinematicsIK<N>::iteratePseudoInverse(const Kinematics& kin, const Position& target, Angles& current, int maxiters, IKStats& stats) const
+{
+	Jacobian jac;
+	Position curpos = kin.jacobian(current, jac);
+	int iters = 0;
+
+	while ((target - curpos).norm() > IKTuning::arrivedThreshold)
+	{
+		if (iters >= maxiters)
+			break;
+
+		Kinematics::advance(current, Kinematics::step(jac, target - curpos));
+		curpos = kin.jacobian(current, jac);
+
+		iters++;
+	}
+
+	stats.iterations += iters;
+	stats.error = (target - curpos).norm();
+	stats.converged = (stats.error <= IKTuning::arrivedThreshold);
+
+	return stats.converged;
+}
+
+template<int N>
+bool FixedKinematicsIK<N>::iterateDamped(const Kinematics& kin, const Position& target, Angles& current, IKStats& stats) const
+{
+	Jacobian jac;
+	Position curpos = kin.jacobian(current, jac);
+	double dist = (target - curpos).norm();
+	double lambda = IKTuning::initialDamping;
+
+	while (dist > IKTuning::arrivedThreshold && stats.iterations < IKTuning::maxDampedIterations && lambda < IKTuning::maxDamping)
+	{
+		stats.iterations++;
+
+		//
+		// Backtracking, halve the error we ask for until the step actually gets us closer
+		//
+		Position error = target - curpos;
+		bool accepted = false;
+		for (int i = 0; i <= IKTuning::maxBacktracks && !accepted; i++) {
+			Angles dt = Kinematics::step(jac, error, lambda);
+			IKTuning::limitStep(dt);
+
+			Angles next = current;
+			Kinematics::advance(next, dt);
+
+			Jacobian nextjac;
+			Position nextpos = kin.jacobian(next, nextjac);
+			double nextdist = (target - nextpos).norm();
+
+			if (nextdist < dist) {
+				current = next;
+				curpos = nextpos;
+				jac = nextjac;
+				dist = nextdist;
+				accepted = true;
+			}
+			else {
+				error *= 0.5;
+			}
+		}
+
+		lambda = IKTuning::nextDamping(lambda, accepted);
+	}
+
+	stats.error = dist;
+	stats.converged = (dist <= IKTuning::arrivedThreshold);
+
+	return stats.converged;
+}
+
+template<int N>
+QVector<double> FixedKinematicsIK<N>::inverseKinematics(const Translation2d& pt) const
+{
+	IKStats stats;
+	return inverseKinematics(pt, QVector<double>(), stats);
+}
+
+template<int N>
+QVector<double> FixedKinematicsIK<N>::inverseKinematics(const Translation2d& pt, const QVector<double>& seed) const
+{
+	IKStats stats;
+	return inverseKinematics(pt, seed, stats);
+}
+
+template<int N>
+QVector<double> FixedKinematicsIK<N>::inverseKinematics(const Translation2d& pt, const QVector<double>& seed, IKStats& stats) const
+{
+	stats = IKStats();
+
+	if (arm_.count() != N)
+		return QVector<double>();
+
+	Kinematics kin = kinematics();
+	Position target(pt.getX(), pt.getY());
+	Angles current = toAngles(seed);
+
+	bool converged;
+	if (method_ == Method::DampedLeastSquares)
+		converged = iterateDamped(kin, target, current, stats);
+	else
+		converged = iteratePseudoInverse(kin, target, current, IKTuning::maxIterations, stats);
+
+	if (!converged)
+		return QVector<double>();
+
+	return fromAngles(current);
+}
+
+template<int N>
+QVector<double> FixedKinematicsIK<N>::inverseKinematicsAlongPath(const Translation2d& pt, const QVector<double>& prev) const
+{
+	if (prev.count() != N || arm_.count() != N)
+		return inverseKinematics(pt);
+
+	if (method_ == Method::DampedLeastSquares)
+		return inverseKinematics(pt, prev);
+
+	//
+	// Predictor and corrector, the same as JacobianIK
+	//
+	Kinematics kin = kinematics();
+	Position target(pt.getX(), pt.getY());
+	Angles current = toAngles(prev);
+
+	Jacobian jac;
+	Position curpos = kin.jacobian(current, jac);
+	Kinematics::advance(current, Kinematics::step(jac, target - curpos));
+
+	IKStats stats;
+	if (iteratePseudoInverse(kin, target, current, IKTuning::maxCorrectorIterations, stats))
+		return fromAngles(current);
+
+	return inverseKinematics(pt, prev);
+}
+
+template class FixedKinematicsIK<2>;
+template class FixedKinematicsIK<3>;
+template class FixedKinematicsIK<4>;
+template class FixedKinematicsIK<5>;
+template class FixedKinematicsIK<6>;
+
+template<int N>
+static InverseKinematics* createFixed(const RobotArm& arm, bool damped)
+{
+	using Method = typename FixedKinematicsIK<N>::Method;
+	return new FixedKinematicsIK<N>(arm, damped ? Method::DampedLeastSquares : Method::PseudoInverse);
+}
+
+InverseKinematics* createFixedKinematicsIK(const RobotArm& arm, int joints, bool damped)
+{
+	switch (joints) {
+	case 2:
+		return createFixed<2>(arm, damped);
+	case 3:
+		return createFixed<3>(arm, damped);
+	case 4:
+		return createFixed<4>(arm, damped);
+	case 5:
+		return createFixed<5>(arm, damped);
+	case 6:
+		return createFixed<6>(arm, damped);
+	default:
+		return nullptr;
+	}
+}
+
+SpecializedIK::SpecializedIK(const RobotArm& arm, InverseKinematics* general, bool damped) : InverseKinematics(arm)
+{
+	general_ = general;
+
+	for (int i = 0; i <= maxFixedJoints; i++) {
+		fixed_.push_back(createFixedKinematicsIK(arm, i, damped));
+	}
+}
+
+SpecializedIK::~SpecializedIK()
+{
+	delete general_;
+
+	for (InverseKinematics* ik : fixed_)
+		delete ik;
+}
+
+const InverseKinematics* SpecializedIK::solver() const
+{
+	//
+	// Joints come and go as the arm is edited, so pick each time
+	//
+	int count = arm_.count();
+	if (count < fixed_.count() && fixed_[count] != nullptr)
+		return fixed_[count];
+
+	return general_;
+}
+
+QVector<double> SpecializedIK::inverseKinematics(const Translation2d& pt) const
+{
+	return solver()->inverseKinematics(pt);
+}
+
+QVector<double> SpecializedIK::inverseKinematics(const Translation2d& pt, const QVector<double>& seed) const
+{
+	return solver()->inverseKinematics(pt, seed);
+}
+
+QVector<double> SpecializedIK::inverseKinematics(const Translation2d& pt, const QVector<double>& seed, IKStats& stats) const
+{
+	return solver()->inverseKinematics(pt, seed, stats);
+}
+
+QVector<double> SpecializedIK::inverseKinematicsAlongPath(const Translation2d& pt, const QVector<double>& prev) const
+{
+	return solver()->inverseKinematicsAlongPath(pt, prev);
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "InverseKinematics.h"
+#include "FixedKinematics.h"
+#include "IKTuning.h"
+
+class RobotArm;
+
+//
+// The Jacobian and damped least squares solvers specialized on the number of joints.  They
+// follow the same iterations as JacobianIK and DampedLeastSquaresIK, with the same IKTuning,
+// but run on the fixed size kernels, so the only allocations are converting the seed in and
+// the answer out.
+//
+template<int N>
+class FixedKinematicsIK : public InverseKinematics
+{
+public:
+	enum class Method
+	{
+		PseudoInverse,
+		DampedLeastSquares
+	};
+
+	using Kinematics = FixedKinematics<N, double>;
+	using Angles = typename Kinematics::Angles;
+	using Position = typename Kinematics::Position;
+	using Jacobian = typename Kinematics::Jacobian;
+
+public:
+	FixedKinematicsIK(const RobotArm& arm, Method method);
+
+	QVector<double> inverseKinematics(const Translation2d& pt) const;
+	QVector<double> inverseKinematics(const Translation2d& pt, const QVector<double>& seed) const;
+	QVector<double> inverseKinematics(const Translation2d& pt, const QVector<double>& seed, IKStats& stats) const;
+	QVector<double> inverseKinematicsAlongPath(const Translation2d& pt, const QVector<double>& prev) const;
+
+private:
+	Kinematics kinematics() const;
+	Angles initialAngles() const;
+	Angles toAngles(const QVector<double>& angles) const;
+	QVector<double> fromAngles(const Angles& angles) const;
+
+	bool iteratePseudoInverse(const Kinematics& kin, const Position& target, Angles& current, int maxiters, IKStats& stats) const;
+	bool iterateDamped(const Kinematics& kin, const Position& target, Angles& current, IKStats& stats) const;
+
+private:
+	Method method_;
+};
+
+//
+// Forwards to the fixed size solver for the current number of joints, or to a general solver
+// when the arm has more joints than there are kernels for.  Owns both.
+//
+class SpecializedIK : public InverseKinematics
+{
+public:
+	SpecializedIK(const RobotArm& arm, InverseKinematics* general, bool damped);
+	virtual ~SpecializedIK();
+
+	QVector<double> inverseKinematics(const Translation2d& pt) const;
+	QVector<double> inverseKinematics(const Translation2d& pt, const QVector<double>& seed) const;
+	QVector<double> inverseKinematics(const Translation2d& pt, const QVector<double>& seed, IKStats& stats) const;
+	QVector<double> inverseKinematicsAlongPath(const Translation2d& pt, const QVector<double>& prev) const;
+
+private:
+	const InverseKinematics* solver() const;
+
+private:
+	InverseKinematics* general_;
+	QVector<InverseKinematics*> fixed_;
+};
+
+//
+// Creates the solver for an arm with the given number of joints, or returns nullptr if
+// there are no kernels for that many joints
+//
+InverseKinematics* createFixedKinematicsIK(const RobotArm& arm, int joints, bool damped);
+
+static constexpr const int minFixedJoints = 2;
+static constexpr const int maxFixedJoints = 6;
@@ -0,0 +1,209 @@
+#include "IKBenchmark.h"
+#include "RobotArm.h"
+#include "MathUtils.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <numeric>
+#include <random>
+
+IKBenchmark::IKBenchmark(const RobotArm& arm, int targets) : arm_(arm)
+{
+	//
+	// An arm with no joints has nowhere to reach, so there is nothing to benchmark
+	//
+	if (arm_.count() == 0 || targets <= 0)
+		return;
+
+	BatchKinematics::PositionSet positions = BatchKinematics(arm_).forwardKinematics(randomAngles(targets));
+
+	for (int i = 0; i < targets; i++) {
+		targets_.push_back(Translation2d(positions(0, i), positions(1, i)));
+	}
+}
+
+BatchKinematics::AngleSet IKBenchmark::randomAngles(int count) const
+{
+	BatchKinematics::AngleSet ret(arm_.count(), count);
+	std::mt19937 rng(randomSeed);
+
+	for (int i = 0; i < count; i++) {
+		for (int j = 0; j < arm_.count(); j++) {
+			const JointDataModel& joint = arm_.at(j);
+			std::uniform_real_distribution<double> dist(-joint.cwConstraint(), joint.ccwConstraint());
+			ret(j, i) = dist(rng);
+		}
+	}
+
+	return ret;
+}
+
+IKBenchmarkResult IKBenchmark::run(const QString& name) const
+{
+	IKBenchmarkResult result;
+	result.name = name;
+
+	const InverseKinematics* solver = arm_.ikSolverByName(name);
+	if (solver == nullptr || !solver->supportsArm() || targets_.isEmpty())
+		return result;
+
+	QVector<double> latencies;
+	double iterations = 0.0;
+
+	for (const Translation2d& pt : targets_) {
+		IKStats stats;
+
+		auto start = std::chrono::steady_clock::now();
+		QVector<double> angles = solver->inverseKinematics(pt, QVector<double>(), stats);
+		auto end = std::chrono::steady_clock::now();
+
+		latencies.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+		iterations += stats.iterations;
+		result.maxIterations = std::max(result.maxIterations, stats.iterations);
+
+		//
+		// Check the answer rather than trusting the solver's own report
+		//
+		if (angles.count() == arm_.count() && arm_.forwardKinematics(angles).distance(pt) <= arrivedThreshold) {
+			result.solved++;
+			if (!arm_.withinLimits(angles))
+				result.violations++;
+		}
+	}
+
+	std::sort(latencies.begin(), latencies.end());
+
+	result.targets = targets_.count();
+	result.meanLatency = std::accumulate(latencies.begin(), latencies.end(), 0.0) / latencies.count();
+	result.p99Latency = latencies[std::min(static_cast<int>(latencies.count() * 0.99), static_cast<int>(latencies.count()) - 1)];
+	result.meanIterations = iterations / targets_.count();
+
+	return result;
+}
+
+QVector<IKBenchmarkResult> IKBenchmark::run() const
+{
+	QVector<IKBenchmarkResult> ret;
+
+	if (targets_.isEmpty())
+		return ret;
+
+	for (const QString& name : arm_.ikSolverNames()) {
+		ret.push_back(run(name));
+	}
+
+	return ret;
+}
+
+QVector<FKBenchmarkResult> IKBenchmark::runForwardKinematics(int configurations) const
+{
+	QVector<FKBenchmarkResult> ret;
+
+	if (arm_.count() == 0 || configurations <= 0)
+		return ret;
+
+	BatchKinematics::AngleSet angles = randomAngles(configurations);
+	BatchKinematics batch(arm_);
+
+	auto timed = [&](const QString& name, const std::function<void()>& fn) {
+		FKBenchmarkResult result;
+		result.name = name;
+		result.configurations = configurations;
+
+		auto start = std::chrono::steady_clock::now();
+		fn();
+		auto end = std::chrono::steady_clock::now();
+
+		double seconds = std::chrono::duration<double>(end - start).count();
+		result.rate = seconds > 0.0 ? configurations / seconds : 0.0;
+		ret.push_back(result);
+	};
+
+	//
+	// The sum of the results keeps the compiler from throwing the work away
+	//
+	double sum = 0.0;
+
+	timed("One at a time", [&]() {
+		QVector<double> one(arm_.count());
+		for (int i = 0; i < configurations; i++) {
+			for (int j = 0; j < arm_.count(); j++) {
+				one[j] = angles(j, i);
+			}
+			sum += arm_.forwardKinematics(one).getX();
+		}
+	});
+
+	timed("Batch, scalar", [&]() {
+		sum += batch.forwardKinematics(angles, BatchKinematics::Kernel::Scalar, false).sum();
+	});
+
+	if (BatchKinematics::hasAVX2()) {
+		timed("Batch, AVX2", [&]() {
+			sum += batch.forwardKinematics(angles, BatchKinematics::Kernel::AVX2, false).sum();
+		});
+	}
+
+	timed("Batch, all cores", [&]() {
+		sum += batch.forwardKinematics(angles).sum();
+	});
+
+	if (std::isnan(sum))
+		ret.clear();
+
+	return ret;
+}
+
+QString IKBenchmark::report(const QVector<FKBenchmarkResult>& results)
+{
+	QString ret;
+
+	ret += "<table cellpadding=\"4\">";
+	ret += "<tr><th align=\"left\">Forward Kinematics</th><th>Configurations / s</th><th>Speedup</th></tr>";
+
+	for (const FKBenchmarkResult& result : results) {
+		ret += "<tr><td>" + result.name + "</td>";
+		ret += "<td align=\"right\">" + QString::number(result.rate / 1.0e6, 'f', 2) + "M</td>";
+
+		//
+		// A run too quick for the clock to measure has no rate to compare against
+		//
+		if (results.front().rate > 0.0)
+			ret += "<td align=\"right\">" + QString::number(result.rate / results.front().rate, 'f', 1) + "x</td></tr>";
+		else
+			ret += "<td align=\"right\">-</td></tr>";
+	}
+
+	ret += "</table>";
+
+	return ret;
+}
+
+QString IKBenchmark::report(const QVector<IKBenchmarkResult>& results)
+{
+	QString ret;
+
+	ret += "<table cellpadding=\"4\">";
+	ret += "<tr><th align=\"left\">Solver</th><th>Solved</th><th>Limit Violations</th><th>Mean (us)</th><th>P99 (us)</th><th>Mean Iterations</th><th>Max Iterations</th></tr>";
+
+	for (const IKBenchmarkResult& result : results) {
+		ret += "<tr><td>" + result.name + "</td>";
+
+		if (result.targets == 0) {
+			ret += "<td colspan=\"6\" align=\"center\">not supported for this arm</td></tr>";
+			continue;
+		}
+
+		ret += "<td align=\"right\">" + QString::number(100.0 * result.solved / result.targets, 'f', 1) + "%</td>";
+		ret += "<td align=\"right\">" + QString::number(result.violations) + "</td>";
+		ret += "<td align=\"right\">" + QString::number(result.meanLatency, 'f', 1) + "</td>";
+		ret += "<td align=\"right\">" + QString::number(result.p99Latency, 'f', 1) + "</td>";
+		ret += "<td align=\"right\">" + QString::number(result.meanIterations, 'f', 1) + "</td>";
+		ret += "<td align=\"right\">" + QString::number(result.maxIterations) + "</td></tr>";
+	}
+
+	ret += "</table>";
+
+	return ret;
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <QtCore/QString>
+#include <QtCore/QVector>
+#include "Translation2d.h"
+#include "BatchKinematics.h"
+
+class RobotArm;
+
+//
+// The results of running one solver over the benchmark targets
+//
+struct IKBenchmarkResult
+{
+	IKBenchmarkResult() {
+		targets = 0;
+		solved = 0;
+		violations = 0;
+		meanLatency = 0.0;
+		p99Latency = 0.0;
+		meanIterations = 0.0;
+		maxIterations = 0;
+	}
+
+	QString name;
+
+	//
+	// Targets attempted, and how many came back within the arrival threshold
+	//
+	int targets;
+	int solved;
+
+	//
+	// Solutions that reached the target with a joint outside its limits
+	//
+	int violations;
+
+	//
+	// Time per solve in microseconds
+	//
+	double meanLatency;
+	double p99Latency;
+
+	//
+	// Iterations per solve, zero for solvers that do not iterate or do not report it
+	//
+	double meanIterations;
+	int maxIterations;
+};
+
+//
+// The forward kinematics throughput of one way of evaluating the arm
+//
+struct FKBenchmarkResult
+{
+	FKBenchmarkResult() {
+		configurations = 0;
+		rate = 0.0;
+	}
+
+	QString name;
+	int configurations;
+
+	//
+	// Configurations per second
+	//
+	double rate;
+};
+
+//
+// Runs every inverse kinematics solver registered for an arm over the same set of reachable
+// targets so the solvers can be compared head to head.  The targets are the end effector
+// positions of random joint angles within the joint limits, from a fixed random seed so the
+// runs are repeatable.
+//
+class IKBenchmark
+{
+public:
+	IKBenchmark(const RobotArm& arm, int targets = DefaultTargets);
+
+	QVector<IKBenchmarkResult> run() const;
+	IKBenchmarkResult run(const QString& solver) const;
+
+	static QString report(const QVector<IKBenchmarkResult>& results);
+
+	//
+	// Times forward kinematics over random joint angles within the limits, one configuration
+	// at a time through the arm and in batches through each batch kernel
+	//
+	QVector<FKBenchmarkResult> runForwardKinematics(int configurations = DefaultConfigurations) const;
+
+	static QString report(const QVector<FKBenchmarkResult>& results);
+
+public:
+	static constexpr const int DefaultTargets = 1000;
+	static constexpr const int DefaultConfigurations = 1000000;
+
+private:
+	BatchKinematics::AngleSet randomAngles(int count) const;
+
+private:
+	static constexpr const double arrivedThreshold = 0.1;
+	static constexpr const unsigned int randomSeed = 6782;
+
+private:
+	const RobotArm& arm_;
+	QVector<Translation2d> targets_;
+};
@@ -0,0 +1,300 @@
+#include "IKLookupTable.h"
+#include "RobotArm.h"
+#include "ThreadPool.h"
+#include "MathUtils.h"
+#include <QtCore/QDir>
+#include <QtCore/QStandardPaths>
+#include <QtCore/QFileInfo>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+IKLookupTable::IKLookupTable()
+{
+	key_ = 0;
+	joints_ = 0;
+	rsteps_ = 0;
+	tsteps_ = 0;
+	rmin_ = 0.0;
+	rstep_ = RadialStep;
+	data_ = nullptr;
+}
+
+IKLookupTable::~IKLookupTable()
+{
+	//
+	// Closing the file releases the mapping data_ points into
+	//
+	data_ = nullptr;
+	file_.reset();
+}
+
+uint64_t IKLookupTable::keyFor(const RobotArm& arm)
+{
+	//
+	// FNV-1a over everything that changes the solutions relative to the base of the arm
+	//
+	uint64_t hash = 14695981039346656037ULL;
+	auto mix = [&hash](double v) {
+		unsigned char bytes[sizeof(double)];
+		std::memcpy(bytes, &v, sizeof(double));
+		for (unsigned char b : bytes) {
+			hash ^= b;
+			hash *= 1099511628211ULL;
+		}
+	};
+
+	mix(static_cast<double>(Version));
+	mix(static_cast<double>(arm.count()));
+	for (const JointDataModel& joint : arm.joints()) {
+		mix(joint.length());
+		mix(joint.initialAngle());
+		mix(joint.cwConstraint());
+		mix(joint.ccwConstraint());
+	}
+
+	return hash;
+}
+
+QString IKLookupTable::cacheFileName(uint64_t key)
+{
+	QString dir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+	return QDir(dir).filePath("iktable-" + QString::number(static_cast<qulonglong>(key), 16) + ".bin");
+}
+
+std::shared_ptr<IKLookupTable> IKLookupTable::build(const RobotArm& arm, std::function<bool()> cancelled)
+{
+	std::shared_ptr<IKLookupTable> table(new IKLookupTable());
+
+	double longest = 0.0;
+	for (const JointDataModel& joint : arm.joints()) {
+		longest = std::max(longest, joint.length());
+	}
+	double rmax = arm.maxArmLength();
+
+	table->key_ = arm.tableKey();
+	table->joints_ = arm.count();
+	table->rmin_ = std::max(0.0, 2.0 * longest - rmax);
+	table->rstep_ = RadialStep;
+	table->rsteps_ = std::max(1, static_cast<int>(std::ceil((rmax - table->rmin_) / RadialStep)) + 1);
+	table->tsteps_ = static_cast<int>(360.0 / AngleStep);
+	table->owned_.assign(static_cast<size_t>(table->rsteps_) * table->tsteps_ * table->joints_, std::numeric_limits<float>::quiet_NaN());
+	table->data_ = table->owned_.data();
+
+	if (table->joints_ == 0)
+		return table;
+
+	//
+	// Walk out from the base across the rings first, each solve continuing from the ring
+	// inside it, so that every ring starts on the same branch as its neighbors.  Then each
+	// ring walks around the base from its start, so every solve continues from the one next
+	// to it, and the rings are solved in parallel.
+	//
+	IKLookupTable* t = table.get();
+	QVector<QVector<double>> starts(t->rsteps_);
+	QVector<double> prev;
+	for (int r = 0; r < t->rsteps_; r++) {
+		if (cancelled && cancelled())
+			return nullptr;
+
+		Translation2d pt = arm.pos() + Translation2d(-(t->rmin_ + r * t->rstep_), 0.0);
+		QVector<double> angles = arm.solveWithoutTable(pt, prev);
+		if (!angles.isEmpty())
+			prev = angles;
+
+		starts[r] = prev;
+	}
+
+	std::atomic<bool> stopped(false);
+	ThreadPool::global().parallelFor(t->rsteps_, [t, &arm, &starts, &cancelled, &stopped](int r) {
+		if (stopped || (cancelled && cancelled())) {
+			stopped = true;
+			return;
+		}
+
+		double radius = t->rmin_ + r * t->rstep_;
+		QVector<double> prev = starts[r];
+
+		for (int i = 0; i < t->tsteps_; i++) {
+			double angle = MathUtils::degreesToRadians(-180.0 + i * AngleStep);
+			Translation2d pt = arm.pos() + Translation2d(std::cos(angle) * radius, std::sin(angle) * radius);
+
+			QVector<double> angles = arm.solveWithoutTable(pt, prev);
+			if (angles.isEmpty())
+				continue;
+
+			float* dest = t->owned_.data() + (static_cast<size_t>(r) * t->tsteps_ + i) * t->joints_;
+			for (int j = 0; j < t->joints_; j++) {
+				dest[j] = static_cast<float>(angles[j]);
+			}
+			prev = angles;
+		}
+	});
+
+	if (stopped)
+		return nullptr;
+
+	return table;
+}
+
+bool IKLookupTable::save(const QString& filename) const
+{
+	QFile file(filename);
+	if (!file.open(QIODevice::OpenModeFlag::Truncate | QIODevice::OpenModeFlag::WriteOnly))
+		return false;
+
+	Header header;
+	std::memset(&header, 0, sizeof(header));
+	header.magic = Magic;
+	header.version = Version;
+	header.key = key_;
+	header.joints = joints_;
+	header.rsteps = rsteps_;
+	header.tsteps = tsteps_;
+	header.rmin = rmin_;
+	header.rstep = rstep_;
+
+	qint64 bytes = static_cast<qint64>(rsteps_) * tsteps_ * joints_ * sizeof(float);
+	bool ok = file.write(reinterpret_cast<const char*>(&header), sizeof(header)) == sizeof(header);
+	ok = ok && file.write(reinterpret_cast<const char*>(data_), bytes) == bytes;
+	file.close();
+
+	return ok;
+}
+
+std::shared_ptr<IKLookupTable> IKLookupTable::load(const QString& filename, uint64_t key)
+{
+	auto file = std::make_unique<QFile>(filename);
+	if (!file->open(QIODevice::OpenModeFlag::ReadOnly))
+		return nullptr;
+
+	if (file->size() < static_cast<qint64>(sizeof(Header)))
+		return nullptr;
+
+	uchar* mem = file->map(0, file->size());
+	if (mem == nullptr)
+		return nullptr;
+
+	Header header;
+	std::memcpy(&header, mem, sizeof(header));
+
+	qint64 bytes = static_cast<qint64>(header.rsteps) * header.tsteps * header.joints * sizeof(float);
+	if (header.magic != Magic || header.version != Version || header.key != key || file->size() != static_cast<qint64>(sizeof(Header)) + bytes) {
+		file->unmap(mem);
+		return nullptr;
+	}
+
+	std::shared_ptr<IKLookupTable> table(new IKLookupTable());
+	table->key_ = header.key;
+	table->joints_ = header.joints;
+	table->rsteps_ = header.rsteps;
+	table->tsteps_ = header.tsteps;
+	table->rmin_ = header.rmin;
+	table->rstep_ = header.rstep;
+	table->data_ = reinterpret_cast<const float*>(mem + sizeof(Header));
+	table->file_ = std::move(file);
+
+	return table;
+}
+
+std::shared_ptr<IKLookupTable> IKLookupTable::loadOrBuild(const RobotArm& arm, std::function<bool()> cancelled)
+{
+	uint64_t key = arm.tableKey();
+	QString filename = cacheFileName(key);
+
+	std::shared_ptr<IKLookupTable> table = load(filename, key);
+	if (table != nullptr)
+		return table;
+
+	table = build(arm, cancelled);
+	if (table == nullptr)
+		return nullptr;
+
+	QString dir = QFileInfo(filename).absolutePath();
+	QDir().mkpath(dir);
+	if (table->save(filename))
+		pruneCache(dir);
+
+	return table;
+}
+
+void IKLookupTable::pruneCache(const QString& dir)
+{
+	//
+	// Newest first, so the table just saved is always kept
+	//
+	QFileInfoList files = QDir(dir).entryInfoList(QStringList() << "iktable-*.bin", QDir::Files, QDir::Time);
+	for (int i = MaxCachedTables; i < files.count(); i++) {
+		QFile::remove(files[i].absoluteFilePath());
+	}
+}
+
+bool IKLookupTable::seed(const Translation2d& local, QVector<double>& angles, bool interpolate) const
+{
+	if (joints_ == 0)
+		return false;
+
+	double fr = (local.normalize() - rmin_) / rstep_;
+	double ft = (MathUtils::radiansToDegrees(std::atan2(local.getY(), local.getX())) + 180.0) / AngleStep;
+
+	if (fr < 0.0 || fr > rsteps_ - 1)
+		return false;
+
+	int r0 = std::min(static_cast<int>(fr), rsteps_ - 1);
+	int r1 = std::min(r0 + 1, rsteps_ - 1);
+	int t0 = static_cast<int>(ft) % tsteps_;
+	int t1 = (t0 + 1) % tsteps_;
+	double wr = fr - r0;
+	double wt = ft - std::floor(ft);
+
+	const int rs[4] = { r0, r1, r0, r1 };
+	const int ts[4] = { t0, t0, t1, t1 };
+	const double ws[4] = { (1 - wr) * (1 - wt), wr * (1 - wt), (1 - wr) * wt, wr * wt };
+
+	bool blend = interpolate;
+	int nearest = -1;
+	for (int c = 0; c < 4; c++) {
+		if (!valid(rs[c], ts[c])) {
+			blend = false;
+			continue;
+		}
+
+		if (nearest == -1 || ws[c] > ws[nearest])
+			nearest = c;
+	}
+
+	if (nearest == -1)
+		return false;
+
+	const float* base = cell(rs[nearest], ts[nearest]);
+	angles.resize(joints_);
+
+	if (blend) {
+		//
+		// Blend each joint relative to the nearest corner so angles on either side of
+		// +/-180 average correctly, and give up if the corners are on different branches
+		//
+		for (int j = 0; j < joints_ && blend; j++) {
+			double sum = 0.0;
+			for (int c = 0; c < 4; c++) {
+				double delta = MathUtils::boundDegrees(cell(rs[c], ts[c])[j] - base[j]);
+				if (std::fabs(delta) > MaxBlendSpread) {
+					blend = false;
+					break;
+				}
+				sum += ws[c] * delta;
+			}
+			angles[j] = MathUtils::boundDegrees(base[j] + sum);
+		}
+	}
+
+	if (!blend) {
+		for (int j = 0; j < joints_; j++) {
+			angles[j] = base[j];
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include "Translation2d.h"
+#include <QtCore/QVector>
+#include <QtCore/QString>
+#include <QtCore/QFile>
+#include <memory>
+#include <functional>
+#include <vector>
+#include <cstdint>
+#include <cmath>
+
+class RobotArm;
+
+//
+// A converged joint solution for every cell of a polar grid covering the annulus the arm can
+// reach.  For a given set of joints inverse kinematics is a pure function of the target, so the
+// table is built once, saved to disk and mapped back into memory the next time the same arm
+// is loaded.  The grid is relative to the base of the arm, so moving the base does not
+// invalidate it.
+//
+class IKLookupTable
+{
+public:
+	virtual ~IKLookupTable();
+
+	//
+	// Identifies the joint configuration a table was built for
+	//
+	static uint64_t keyFor(const RobotArm& arm);
+
+	//
+	// Building takes a while, so it calls cancelled every so often and returns nullptr, without
+	// saving anything, as soon as that returns true
+	//
+	static std::shared_ptr<IKLookupTable> build(const RobotArm& arm, std::function<bool()> cancelled = std::function<bool()>());
+	static std::shared_ptr<IKLookupTable> load(const QString& filename, uint64_t key);
+	static std::shared_ptr<IKLookupTable> loadOrBuild(const RobotArm& arm, std::function<bool()> cancelled = std::function<bool()>());
+	static QString cacheFileName(uint64_t key);
+
+	bool save(const QString& filename) const;
+
+	uint64_t key() const {
+		return key_;
+	}
+
+	int joints() const {
+		return joints_;
+	}
+
+	//
+	// Fill in angles with a starting point for solving for the target, which is relative to the
+	// base of the arm.  If interpolate is true, the solutions at the four surrounding cells are
+	// blended when they agree, otherwise the nearest cell is used.  Returns false if there is no
+	// solution near the target.
+	//
+	bool seed(const Translation2d& local, QVector<double>& angles, bool interpolate = true) const;
+
+private:
+	IKLookupTable();
+
+	const float* cell(int r, int t) const {
+		return data_ + (static_cast<size_t>(r) * tsteps_ + t) * joints_;
+	}
+
+	bool valid(int r, int t) const {
+		return !std::isnan(cell(r, t)[0]);
+	}
+
+	static void pruneCache(const QString& dir);
+
+private:
+	struct Header
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint64_t key;
+		int32_t joints;
+		int32_t rsteps;
+		int32_t tsteps;
+		int32_t pad;
+		double rmin;
+		double rstep;
+	};
+
+	static constexpr const uint32_t Magic = 0x4b494158;		// "XAIK"
+	static constexpr const uint32_t Version = 1;
+
+	//
+	// Grid spacing, in arm units radially and degrees around the base
+	//
+	static constexpr const double RadialStep = 1.0;
+	static constexpr const double AngleStep = 1.0;
+
+	//
+	// Corner solutions further apart than this are on different branches and are not blended
+	//
+	static constexpr const double MaxBlendSpread = 45.0;
+
+	//
+	// Every set of joints the arm has been edited through leaves a table in the cache, so only
+	// this many of the most recently built ones are kept
+	//
+	static constexpr const int MaxCachedTables = 16;
+
+private:
+	uint64_t key_;
+	int joints_;
+	int rsteps_;
+	int tsteps_;
+	double rmin_;
+	double rstep_;
+
+	//
+	// The cell data, either owned by the table after a build or mapped from the file
+	//
+	const float* data_;
+	std::vector<float> owned_;
+	std::unique_ptr<QFile> file_;
+};
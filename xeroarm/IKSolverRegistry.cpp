@@ -0,0 +1,82 @@
+#include "IKSolverRegistry.h"
+#include "AnalyticIK.h"
+#include "JacobianIK.h"
+#include "DampedLeastSquaresIK.h"
+#include "FabrikIK.h"
+#include "JointLimitIK.h"
+#include "AnnealingIK.h"
+#include "FixedKinematicsIK.h"
+
+IKSolverRegistry::IKSolverRegistry()
+{
+	add("Analytic", [](const RobotArm& arm) {
+		return new AnalyticIK(arm);
+	});
+
+	add("Jacobian", [](const RobotArm& arm) {
+		return new SpecializedIK(arm, new JacobianIK(arm), false);
+	});
+
+	add("Damped Least Squares", [](const RobotArm& arm) {
+		return new SpecializedIK(arm, new DampedLeastSquaresIK(arm), true);
+	});
+
+	add("FABRIK", [](const RobotArm& arm) {
+		return new FabrikIK(arm);
+	});
+
+	add("Joint Limits", [](const RobotArm& arm) {
+		return new JointLimitIK(arm);
+	});
+
+	add("Annealing", [](const RobotArm& arm) {
+		return new AnnealingIK(arm);
+	});
+}
+
+IKSolverRegistry& IKSolverRegistry::global()
+{
+	static IKSolverRegistry registry;
+	return registry;
+}
+
+void IKSolverRegistry::add(const QString& name, Factory factory)
+{
+	std::lock_guard guard(lock_);
+
+	for (Entry& entry : entries_) {
+		if (entry.name == name) {
+			entry.factory = factory;
+			return;
+		}
+	}
+
+	Entry entry;
+	entry.name = name;
+	entry.factory = factory;
+	entries_.push_back(entry);
+}
+
+QStringList IKSolverRegistry::names() const
+{
+	std::lock_guard guard(lock_);
+
+	QStringList ret;
+	for (const Entry& entry : entries_) {
+		ret.push_back(entry.name);
+	}
+
+	return ret;
+}
+
+QVector<QPair<QString, InverseKinematics*>> IKSolverRegistry::createAll(const RobotArm& arm) const
+{
+	std::lock_guard guard(lock_);
+
+	QVector<QPair<QString, InverseKinematics*>> ret;
+	for (const Entry& entry : entries_) {
+		ret.push_back(qMakePair(entry.name, entry.factory(arm)));
+	}
+
+	return ret;
+}
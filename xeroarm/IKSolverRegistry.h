@@ -0,0 +1,46 @@
+#pragma once
+
+#include "InverseKinematics.h"
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+#include <QtCore/QVector>
+#include <QtCore/QPair>
+#include <functional>
+#include <mutex>
+
+class RobotArm;
+
+//
+// The inverse kinematics solvers that can be selected for an arm, by name.  Every RobotArm
+// creates one instance of each registered solver, so a solver added here shows up in the
+// Inverse Kinematics menu and in the solver benchmark without any other changes.
+//
+class IKSolverRegistry
+{
+public:
+	typedef std::function<InverseKinematics* (const RobotArm& arm)> Factory;
+
+public:
+	IKSolverRegistry();
+
+	static IKSolverRegistry& global();
+
+	void add(const QString& name, Factory factory);
+	QStringList names() const;
+
+	//
+	// Create one of every registered solver for the arm, in the order they were registered
+	//
+	QVector<QPair<QString, InverseKinematics*>> createAll(const RobotArm& arm) const;
+
+private:
+	struct Entry
+	{
+		QString name;
+		Factory factory;
+	};
+
+private:
+	mutable std::mutex lock_;
+	QVector<Entry> entries_;
+};
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <Eigen/Dense>
+#include <algorithm>
+
+//
+// The iteration limits and tuning shared by the Jacobian and damped least squares solvers,
+// both the general ones and the fixed size ones built on FixedKinematics, so the two kinds
+// take the same steps and stop in the same places
+//
+class IKTuning
+{
+public:
+	IKTuning() = delete;
+	~IKTuning() = delete;
+
+	//
+	// How close the end effector must get to the target to count as there
+	//
+	static constexpr const double arrivedThreshold = 0.1;
+
+	//
+	// Pseudo inverse iterations for a full solve, and for the corrector after a prediction
+	// along a path
+	//
+	static constexpr const int maxIterations = 10000;
+	static constexpr const int maxCorrectorIterations = 2;
+
+	//
+	// Damped least squares iterations, the halvings of the error tried within each one, and
+	// the range of the damping
+	//
+	static constexpr const int maxDampedIterations = 100;
+	static constexpr const int maxBacktracks = 4;
+	static constexpr const double initialDamping = 1.0;
+	static constexpr const double minDamping = 1.0e-4;
+	static constexpr const double maxDamping = 1.0e4;
+
+	//
+	// The largest joint move in degrees a damped step may make
+	//
+	static constexpr const double maxStep = 30.0;
+
+	//
+	// Scales a damped step down so its largest joint move is maxStep, so a single step can
+	// not swing the arm around to a different solution
+	//
+	template<typename Derived>
+	static void limitStep(Eigen::MatrixBase<Derived>& dt) {
+		double largest = dt.cwiseAbs().maxCoeff();
+		if (largest > maxStep)
+			dt *= maxStep / largest;
+	}
+
+	//
+	// Trust the linear model more when a step works and less when it does not
+	//
+	static double nextDamping(double lambda, bool accepted) {
+		if (accepted)
+			return std::max(minDamping, lambda * 0.5);
+
+		return lambda * 4.0;
+	}
+};
@@ -0,0 +1,61 @@
+#include "InverseKinematics.h"
+#include "RobotArm.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <limits>
+
+Eigen::MatrixXd InverseKinematics::inverseKinematicsBatch(const QVector<Translation2d>& targets, const Eigen::MatrixXd& seeds) const
+{
+	const int joints = arm_.count();
+	const int count = targets.count();
+	const bool seeded = (seeds.rows() == joints && seeds.cols() == count && count > 1);
+
+	Eigen::MatrixXd ret(joints, count);
+
+	//
+	// A chunk that started from the initial angles of the arm could land on a different branch
+	// than the end of the chunk before it, and where the chunks start depends on the number of
+	// threads.  So only split the targets up when each one has its own seed.
+	//
+	ThreadPool& pool = ThreadPool::global();
+	int chunks = seeded ? std::max(1, std::min(pool.threadCount(), count / minBatchChunk)) : 1;
+
+	pool.parallelFor(chunks, [&](int chunk) {
+		int first = static_cast<int>(static_cast<long long>(count) * chunk / chunks);
+		int last = static_cast<int>(static_cast<long long>(count) * (chunk + 1) / chunks);
+		QVector<double> prev;
+
+		if (!seeded && seeds.rows() == joints && seeds.cols() == 1) {
+			for (int j = 0; j < joints; j++) {
+				prev.push_back(seeds(j, 0));
+			}
+		}
+
+		for (int i = first; i < last; i++) {
+			QVector<double> angles;
+
+			if (seeded) {
+				QVector<double> seed(joints);
+				for (int j = 0; j < joints; j++) {
+					seed[j] = seeds(j, i);
+				}
+				angles = inverseKinematics(targets[i], seed);
+			}
+			else {
+				angles = inverseKinematicsAlongPath(targets[i], prev);
+			}
+
+			if (angles.isEmpty()) {
+				ret.col(i).setConstant(std::numeric_limits<double>::quiet_NaN());
+			}
+			else {
+				for (int j = 0; j < joints; j++) {
+					ret(j, i) = angles[j];
+				}
+				prev = angles;
+			}
+		}
+	});
+
+	return ret;
+}
@@ -1,11 +1,116 @@
 #pragma once
 
 #include "Translation2d.h"
+#include "Pose2d.h"
 #include <QtCore/QVector>
+#include <Eigen/Dense>
+
+class RobotArm;
+
+//
+// What it took to solve a single target
+//
+struct IKStats
+{
+	IKStats() {
+		iterations = 0;
+		error = 0.0;
+		converged = false;
+	}
+
+	//
+	// The number of iterations the solver took, zero for closed form solvers
+	//
+	int iterations;
+
+	//
+	// The distance between the target and the end of the arm for the final joint angles
+	//
+	double error;
+
+	//
+	// If true, the solver reached the target and returned a solution
+	//
+	bool converged;
+};
 
 class InverseKinematics
 {
 public:
+	InverseKinematics(const RobotArm& arm) : arm_(arm) {
+	}
+
+	virtual ~InverseKinematics() {
+	}
+
 	virtual QVector<double> inverseKinematics(const Translation2d& pt) const = 0;
-};
 
+	//
+	// False if the solver cannot handle the arm as it is currently configured
+	//
+	virtual bool supportsArm() const {
+		return true;
+	}
+
+	//
+	// Solve for the target starting from the given joint angles instead of the initial
+	// position of the arm.  Solvers that cannot use a starting point ignore it.
+	//
+	virtual QVector<double> inverseKinematics(const Translation2d& pt, const QVector<double>& seed) const {
+		return inverseKinematics(pt);
+	}
+
+	//
+	// Solve for the target starting from the given joint angles, reporting what it took to
+	// get there.  Solvers that do not track their progress only report if they converged.
+	//
+	virtual QVector<double> inverseKinematics(const Translation2d& pt, const QVector<double>& seed, IKStats& stats) const {
+		QVector<double> ret = inverseKinematics(pt, seed);
+		stats = IKStats();
+		stats.converged = !ret.isEmpty();
+		return ret;
+	}
+
+	//
+	// Solve for a target that is a small step along a path from a point whose solution, prev,
+	// is already known.  This is the call to use when walking a path sample by sample.
+	//
+	virtual QVector<double> inverseKinematicsAlongPath(const Translation2d& pt, const QVector<double>& prev) const {
+		return inverseKinematics(pt, prev);
+	}
+
+	//
+	// Every solution for the target pose that the solver can find.  Solvers that can place the
+	// last link use the heading of the pose, the rest only solve for its position and return at
+	// most a single solution.
+	//
+	virtual QVector<QVector<double>> solutions(const Pose2d& pose) const {
+		QVector<QVector<double>> ret;
+		QVector<double> angles = inverseKinematics(pose.getTranslation());
+		if (!angles.isEmpty())
+			ret.push_back(angles);
+
+		return ret;
+	}
+
+	//
+	// Solve for many targets in one call.  The result has one column of joint angles per target,
+	// and the column is NaN where the target could not be solved.  If seeds has a column per
+	// target each solve starts from its seed, and the targets are split into chunks that are
+	// solved in parallel.  Otherwise each solve continues from the one before it, so neighboring
+	// targets should be close together, such as the samples along a path.  The first starts from
+	// the single column of seeds if there is one.  That makes every target depend on the one
+	// before it, so they are solved in order.  Paths are generated in parallel with each other
+	// instead.
+	//
+	Eigen::MatrixXd inverseKinematicsBatch(const QVector<Translation2d>& targets, const Eigen::MatrixXd& seeds = Eigen::MatrixXd()) const;
+
+protected:
+	const RobotArm& arm_;
+
+private:
+	//
+	// Below this many targets per chunk, the cost of handing out the work outweighs the gain
+	//
+	static constexpr const int minBatchChunk = 64;
+};
@@ -2,10 +2,11 @@
 #include "Translation2d.h"
 #include "RobotArm.h"
 #include "MathUtils.h"
+#include <cmath>
 
 using Eigen::MatrixXd;
 
-JacobianIK::JacobianIK(const RobotArm& arm) : arm_(arm)
+JacobianIK::JacobianIK(const RobotArm& arm) : InverseKinematics(arm)
 {
 }
 
@@ -14,58 +15,133 @@ MatrixXd JacobianIK::computeJacobian(const QVector<double>& angles) const
 	MatrixXd ret(2, angles.count());
 
 	//
-	// Perform forward kinematics, translate result back to an origin at the
-	// base of joint 0.
+	// Joint j swings everything from its own position out to the end effector about itself, so
+	// its column is the vector from the joint to the end effector rotated by 90 degrees.  One
+	// pass down the chain, relative to the base and with one sin and cos per joint, leaves the
+	// position of each joint in its own column and gives the end effector.
 	//
-	Translation2d here = arm_.forwardKinematics(angles).translateBy(arm_.pos().inverse());
+	double x = 0.0;
+	double y = 0.0;
+	double heading = 0.0;
 
-	for (int i = 0; i < arm_.count(); i++) {
-		QVector<double> deltaangles = angles;
+	for (int i = 0; i < angles.count(); i++) {
+		ret(0, i) = x;
+		ret(1, i) = y;
 
-		deltaangles[i] += deltaTheta;
+		heading += MathUtils::degreesToRadians(angles[i]);
+		x += arm_.at(i).length() * std::cos(heading);
+		y += arm_.at(i).length() * std::sin(heading);
+	}
 
-		Translation2d newhere = arm_.forwardKinematics(deltaangles).translateBy(arm_.pos().inverse());
-		ret(0, i) = (newhere.getX() - here.getX());
-		ret(1, i) = (newhere.getY() - here.getY());
+	//
+	// Joint angles are in degrees, so scale the derivatives to units per degree
+	//
+	const double scale = MathUtils::kPI / 180.0;
+	for (int i = 0; i < angles.count(); i++) {
+		double dx = x - ret(0, i);
+		double dy = y - ret(1, i);
+		ret(0, i) = -dy * scale;
+		ret(1, i) = dx * scale;
 	}
 
 	return ret;
 }
 
-QVector<double> JacobianIK::inverseKinematics(const Translation2d& pt) const
+void JacobianIK::step(const Translation2d& pt, const Translation2d& curpos, QVector<double>& current) const
 {
 	const double alpha = 1.0;
-	int iters = 0;
 
-	QVector<double> current(arm_.count());
+	MatrixXd jacobian = computeJacobian(current);
+	MatrixXd inverse = jacobian.completeOrthogonalDecomposition().pseudoInverse();
+
+	MatrixXd target(2, 1);
+	target(0, 0) = pt.getX() - curpos.getX();
+	target(1, 0) = pt.getY() - curpos.getY();
+
+	MatrixXd dt = inverse * target;
 	for (int i = 0; i < arm_.count(); i++) {
-		current[i] = arm_.at(i).initialAngle();
+		current[i] = MathUtils::boundDegrees(current[i] + dt(i) * alpha);
 	}
+}
+
+bool JacobianIK::iterate(const Translation2d& pt, QVector<double>& current, int maxiters, IKStats& stats) const
+{
+	int iters = 0;
 	Translation2d curpos = arm_.forwardKinematics(current);
 
-	while (curpos.distance(pt) > arrivedThreshold)
+	while (curpos.distance(pt) > IKTuning::arrivedThreshold)
 	{
-		MatrixXd jacobian = computeJacobian(current);
-		MatrixXd inverse = jacobian.completeOrthogonalDecomposition().pseudoInverse();
+		if (iters >= maxiters)
+			break;
 
-		MatrixXd target(2, 1);
-		target(0, 0) = pt.getX() - curpos.getX();
-		target(1, 0) = pt.getY() - curpos.getY();
+		step(pt, curpos, current);
+		curpos = arm_.forwardKinematics(current);
 
-		MatrixXd dt = inverse * target;
-		for (int i = 0; i < arm_.count(); i++) {
-			current[i] = MathUtils::boundDegrees(current[i] + dt(i) * alpha);
-		}
+		iters++;
+	}
 
-		curpos = arm_.forwardKinematics(current);
+	stats.iterations += iters;
+	stats.error = curpos.distance(pt);
+	stats.converged = (stats.error <= IKTuning::arrivedThreshold);
 
-		if (iters > 10000) {
-			current.clear();
-			return current;
-		}
+	return stats.converged;
+}
 
-		iters++;
+QVector<double> JacobianIK::initialAngles() const
+{
+	QVector<double> ret(arm_.count());
+	for (int i = 0; i < arm_.count(); i++) {
+		ret[i] = arm_.at(i).initialAngle();
 	}
 
+	return ret;
+}
+
+QVector<double> JacobianIK::inverseKinematics(const Translation2d& pt) const
+{
+	IKStats stats;
+	return inverseKinematics(pt, initialAngles(), stats);
+}
+
+QVector<double> JacobianIK::inverseKinematics(const Translation2d& pt, const QVector<double>& seed) const
+{
+	IKStats stats;
+	return inverseKinematics(pt, seed, stats);
+}
+
+QVector<double> JacobianIK::inverseKinematics(const Translation2d& pt, const QVector<double>& seed, IKStats& stats) const
+{
+	stats = IKStats();
+
+	QVector<double> current = (seed.count() == arm_.count()) ? seed : initialAngles();
+	if (!iterate(pt, current, IKTuning::maxIterations, stats))
+		current.clear();
+
 	return current;
 }
+
+QVector<double> JacobianIK::inverseKinematicsAlongPath(const Translation2d& pt, const QVector<double>& prev) const
+{
+	if (prev.count() != arm_.count())
+		return inverseKinematics(pt);
+
+	//
+	// Predictor, move from the previous solution along the Jacobian at that solution by
+	// the change in the target position
+	//
+	QVector<double> current = prev;
+	step(pt, arm_.forwardKinematics(current), current);
+
+	//
+	// Corrector, the prediction should be within a couple of iterations of the answer
+	//
+	IKStats stats;
+	if (iterate(pt, current, IKTuning::maxCorrectorIterations, stats))
+		return current;
+
+	//
+	// The step along the path was too large for the prediction, fall back to a full solve
+	// from the previous solution
+	//
+	return inverseKinematics(pt, prev);
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "InverseKinematics.h"
+#include "IKTuning.h"
 #include <QtCore/QVector>
 #include <Eigen/Dense>
 
@@ -12,15 +13,16 @@ public:
 	JacobianIK(const RobotArm& arm);
 
 	QVector<double> inverseKinematics(const Translation2d& pt) const;
+	QVector<double> inverseKinematics(const Translation2d& pt, const QVector<double>& seed) const;
+	QVector<double> inverseKinematics(const Translation2d& pt, const QVector<double>& seed, IKStats& stats) const;
+	QVector<double> inverseKinematicsAlongPath(const Translation2d& pt, const QVector<double>& prev) const;
 
-private:
+protected:
 	Eigen::MatrixXd computeJacobian(const QVector<double>& angles) const;
+	QVector<double> initialAngles() const;
 
 private:
-	static constexpr const double deltaTheta = 2.0;
-	static constexpr const double arrivedThreshold = 0.1;
-
-private:
-	const RobotArm& arm_;
+	void step(const Translation2d& pt, const Translation2d& curpos, QVector<double>& current) const;
+	bool iterate(const Translation2d& pt, QVector<double>& current, int maxiters, IKStats& stats) const;
 };
 
@@ -1,5 +1,6 @@
 #include "JointDataModel.h"
 #include "JsonFileKeywords.h"
+#include "MathUtils.h"
 #include <QtCore/QJsonArray>
 
 QJsonObject JointDataModel::toJson() const
@@ -11,6 +12,9 @@ QJsonObject JointDataModel::toJson() const
 	obj[JsonFileKeywords::InitialAngleKeyword] = initial_angle_;
 	obj[JsonFileKeywords::MaxVelocityKeyword] = maxv_;
 	obj[JsonFileKeywords::MaxAccelKeyword] = maxa_;
+	obj[JsonFileKeywords::MaxJerkKeyword] = maxj_;
+	obj[JsonFileKeywords::CWLimitKeyword] = cw_constraint_;
+	obj[JsonFileKeywords::CCWLimitKeyword] = ccw_constraint_;
 	return obj;
 }
 
@@ -64,5 +68,49 @@ bool JointDataModel::fromJson(const QJsonObject& obj, QString& error)
 
 	maxa_ = obj.value(JsonFileKeywords::MaxAccelKeyword).toDouble();
 
+	//
+	// The joint limits are optional, files written before they were added have none
+	//
+	cw_constraint_ = Unconstrained;
+	if (obj.contains(JsonFileKeywords::CWLimitKeyword)) {
+		if (!obj.value(JsonFileKeywords::CWLimitKeyword).isDouble()) {
+			error = "json file contains member '" + QString(JsonFileKeywords::CWLimitKeyword) + "', but it is not a double";
+			return false;
+		}
+
+		cw_constraint_ = obj.value(JsonFileKeywords::CWLimitKeyword).toDouble();
+	}
+
+	ccw_constraint_ = Unconstrained;
+	if (obj.contains(JsonFileKeywords::CCWLimitKeyword)) {
+		if (!obj.value(JsonFileKeywords::CCWLimitKeyword).isDouble()) {
+			error = "json file contains member '" + QString(JsonFileKeywords::CCWLimitKeyword) + "', but it is not a double";
+			return false;
+		}
+
+		ccw_constraint_ = obj.value(JsonFileKeywords::CCWLimitKeyword).toDouble();
+	}
+
+	//
+	// The jerk limit is optional as well, without one the joint is limited by acceleration alone
+	//
+	maxj_ = 0.0;
+	if (obj.contains(JsonFileKeywords::MaxJerkKeyword)) {
+		if (!obj.value(JsonFileKeywords::MaxJerkKeyword).isDouble()) {
+			error = "json file contains member '" + QString(JsonFileKeywords::MaxJerkKeyword) + "', but it is not a double";
+			return false;
+		}
+
+		maxj_ = obj.value(JsonFileKeywords::MaxJerkKeyword).toDouble();
+	}
+
 	return true;
-}
\ No newline at end of file
+}
+
+bool JointDataModel::withinLimits(double angle) const
+{
+	if (!isConstrained())
+		return true;
+
+	return angle <= ccw_constraint_ + MathUtils::kEpsilon && angle >= -cw_constraint_ - MathUtils::kEpsilon;
+}
@@ -6,6 +6,12 @@
 
 class JointDataModel
 {
+public:
+	//
+	// A limit of this many degrees either way lets the joint turn all the way around
+	//
+	static constexpr const double Unconstrained = 180.0;
+
 public:
 	JointDataModel() {
 		angle_ = 0.0;
@@ -13,8 +19,9 @@ public:
 		initial_angle_ = 0.0;
 		maxa_ = 0.0;
 		maxv_ = 0.0;
-		cw_constraint_ = 0.0;
-		ccw_constraint_ = 0.0;
+		maxj_ = 0.0;
+		cw_constraint_ = Unconstrained;
+		ccw_constraint_ = Unconstrained;
 	}
 
 	JointDataModel(double length, double init) {
@@ -23,8 +30,9 @@ public:
 		initial_angle_ = init;
 		maxv_ = 0.0;
 		maxa_ = 0.0;
-		cw_constraint_ = 0.0;
-		ccw_constraint_ = 0.0;
+		maxj_ = 0.0;
+		cw_constraint_ = Unconstrained;
+		ccw_constraint_ = Unconstrained;
 	}
 
 	double angle() const {
@@ -67,6 +75,43 @@ public:
 		maxa_ = d;
 	}
 
+	//
+	// Zero when the joint has no jerk limit
+	//
+	double maxJerk() const {
+		return maxj_;
+	}
+
+	void setMaxJerk(double d) {
+		maxj_ = d;
+	}
+
+	double cwConstraint() const {
+		return cw_constraint_;
+	}
+
+	void setCWConstraint(double d) {
+		cw_constraint_ = d;
+	}
+
+	double ccwConstraint() const {
+		return ccw_constraint_;
+	}
+
+	void setCCWConstraint(double d) {
+		ccw_constraint_ = d;
+	}
+
+	bool isConstrained() const {
+		return cw_constraint_ < Unconstrained || ccw_constraint_ < Unconstrained;
+	}
+
+	//
+	// True if the joint can be at the angle, in degrees.  A joint that is not constrained can be
+	// at any angle, including one unwrapped past +/-180.
+	//
+	bool withinLimits(double angle) const;
+
 	QJsonObject toJson() const;
 	bool fromJson(const QJsonObject& obj, QString& error);
 
@@ -97,7 +142,13 @@ private:
 	double maxa_;
 
 	//
-	// Constraints for the joint
+	// Max jerk of this joint in degrees/second/second/second, zero for none
+	//
+	double maxj_;
+
+	//
+	// Constraints for the joint, the number of degrees the joint may rotate clockwise and
+	// counter clockwise from being in line with the previous joint.  180 is unconstrained.
 	//
 	double cw_constraint_;
 	double ccw_constraint_;
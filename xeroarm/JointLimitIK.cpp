@@ -0,0 +1,154 @@
+#include "JointLimitIK.h"
+#include "RobotArm.h"
+#include "MathUtils.h"
+#include <cmath>
+
+using Eigen::MatrixXd;
+using Eigen::VectorXd;
+
+JointLimitIK::JointLimitIK(const RobotArm& arm) : JacobianIK(arm)
+{
+}
+
+double JointLimitIK::limit(int joint, double angle) const
+{
+	const JointDataModel& model = arm_.at(joint);
+
+	angle = MathUtils::boundDegrees(angle);
+	if (angle > model.ccwConstraint())
+		angle = model.ccwConstraint();
+	else if (angle < -model.cwConstraint())
+		angle = -model.cwConstraint();
+
+	return angle;
+}
+
+bool JointLimitIK::iterate(const Translation2d& pt, QVector<double>& current, Direction dir, IKStats& stats) const
+{
+	const int joints = arm_.count();
+	const double scale = 180.0 / MathUtils::kPI;
+
+	Translation2d target = pt - arm_.pos();
+	double radius = target.normalize();
+	double bearing = std::atan2(target.getY(), target.getX());
+
+	Translation2d curpos = arm_.forwardKinematics(current);
+	int iters = 0;
+
+	while (curpos.distance(pt) > IKTuning::arrivedThreshold && iters < maxIterations)
+	{
+		iters++;
+
+		//
+		// The Jacobian is per degree, the step is computed per radian so the damping is in the
+		// same units as the error
+		//
+		MatrixXd jpos = computeJacobian(current) * scale;
+		Translation2d error = pt - curpos;
+
+		//
+		// The bearing row only applies while the arm still has more than half a turn to swing
+		// in the chosen direction, after that the shortest way around is the chosen way
+		//
+		Translation2d local = curpos - arm_.pos();
+		double r2 = local.normalizeSquared();
+		double swing = 0.0;
+		if (dir != Direction::Shortest && r2 > IKTuning::arrivedThreshold * IKTuning::arrivedThreshold && radius > IKTuning::arrivedThreshold) {
+			swing = MathUtils::BoundRadians(bearing - std::atan2(local.getY(), local.getX()));
+			if (dir == Direction::CounterClockwise && swing < 0.0)
+				swing += 2.0 * MathUtils::kPI;
+			else if (dir == Direction::Clockwise && swing > 0.0)
+				swing -= 2.0 * MathUtils::kPI;
+
+			if (std::fabs(swing) < MathUtils::kPI)
+				dir = Direction::Shortest;
+		}
+
+		int rows = (dir == Direction::Shortest) ? 2 : 3;
+		MatrixXd jac(rows, joints);
+		VectorXd e(rows);
+
+		jac.topRows(2) = jpos;
+		e(0) = error.getX();
+		e(1) = error.getY();
+
+		if (rows == 3) {
+			//
+			// Bearing measured as arc length at the target radius so it weighs the same as the
+			// position error
+			//
+			for (int i = 0; i < joints; i++) {
+				jac(2, i) = radius * (local.getX() * jpos(1, i) - local.getY() * jpos(0, i)) / r2;
+			}
+			e(2) = radius * swing;
+		}
+
+		//
+		// Joints held at a limit that the error is pushing them further past do not move
+		//
+		VectorXd gradient = jac.transpose() * e;
+		for (int i = 0; i < joints; i++) {
+			const JointDataModel& joint = arm_.at(i);
+			if ((current[i] >= joint.ccwConstraint() && gradient(i) > 0.0) || (current[i] <= -joint.cwConstraint() && gradient(i) < 0.0)) {
+				jac.col(i).setZero();
+			}
+		}
+
+		double energy = 0.5 * e.squaredNorm();
+		MatrixXd damped = jac.transpose() * jac;
+		damped.diagonal().array() += energy + epsilon;
+
+		VectorXd dq = damped.llt().solve(jac.transpose() * e);
+		for (int i = 0; i < joints; i++) {
+			current[i] = limit(i, current[i] + dq(i) * scale);
+		}
+
+		curpos = arm_.forwardKinematics(current);
+	}
+
+	stats.iterations += iters;
+	stats.error = curpos.distance(pt);
+	stats.converged = (stats.error <= IKTuning::arrivedThreshold);
+
+	return stats.converged;
+}
+
+QVector<double> JointLimitIK::inverseKinematics(const Translation2d& pt) const
+{
+	IKStats stats;
+	return inverseKinematics(pt, initialAngles(), stats);
+}
+
+QVector<double> JointLimitIK::inverseKinematics(const Translation2d& pt, const QVector<double>& seed) const
+{
+	IKStats stats;
+	return inverseKinematics(pt, seed, stats);
+}
+
+QVector<double> JointLimitIK::inverseKinematicsAlongPath(const Translation2d& pt, const QVector<double>& prev) const
+{
+	return inverseKinematics(pt, prev);
+}
+
+QVector<double> JointLimitIK::inverseKinematics(const Translation2d& pt, const QVector<double>& seed, IKStats& stats) const
+{
+	stats = IKStats();
+
+	QVector<double> start = (seed.count() == arm_.count()) ? seed : initialAngles();
+	for (int i = 0; i < start.count(); i++) {
+		start[i] = limit(i, start[i]);
+	}
+
+	//
+	// Try the plain solve first, then restart from the same place swinging the arm each
+	// way around the base to get out of a deadlock
+	//
+	const Direction dirs[] = { Direction::Shortest, Direction::CounterClockwise, Direction::Clockwise };
+	for (Direction dir : dirs) {
+		QVector<double> current = start;
+		if (iterate(pt, current, dir, stats))
+			return current;
+	}
+
+	return QVector<double>();
+}
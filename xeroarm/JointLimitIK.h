@@ -0,0 +1,48 @@
+#pragma once
+
+#include "JacobianIK.h"
+
+class RobotArm;
+
+//
+// Inverse kinematics that keeps every joint inside its clockwise and counter clockwise limits,
+// after Sekiguchi and Takesue, "Numerical method for inverse kinematics using an extended
+// angle-axis vector to avoid deadlock caused by joint limits".
+//
+// Each iteration is a Levenberg-Marquardt step damped by the remaining error,
+//
+//    dq = (J^T J + (E + epsilon) I)^-1 J^T e,    E = e^T e / 2
+//
+// A joint that hits a limit is held at the limit and its column of the Jacobian is zeroed so
+// the other joints take up the motion.  Holding joints at their limits can deadlock the solve
+// with the arm wrapped the wrong way around the base.  For a planar arm the extended angle-axis
+// vector reduces to the bearing of the end effector from the base, with the error measured in
+// [0, 360) or (-360, 0] rather than (-180, 180].  Adding it to the error forces the arm to swing
+// around the base in a chosen direction, so when the plain solve deadlocks it is retried
+// swinging counter clockwise and then clockwise.
+//
+class JointLimitIK : public JacobianIK
+{
+public:
+	JointLimitIK(const RobotArm& arm);
+
+	QVector<double> inverseKinematics(const Translation2d& pt) const;
+	QVector<double> inverseKinematics(const Translation2d& pt, const QVector<double>& seed) const;
+	QVector<double> inverseKinematics(const Translation2d& pt, const QVector<double>& seed, IKStats& stats) const;
+	QVector<double> inverseKinematicsAlongPath(const Translation2d& pt, const QVector<double>& prev) const;
+
+private:
+	enum class Direction
+	{
+		Shortest,
+		CounterClockwise,
+		Clockwise
+	};
+
+	double limit(int joint, double angle) const;
+	bool iterate(const Translation2d& pt, QVector<double>& current, Direction dir, IKStats& stats) const;
+
+private:
+	static constexpr const int maxIterations = 200;
+	static constexpr const double epsilon = 1.0e-3;
+};
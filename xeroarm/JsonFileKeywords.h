@@ -23,4 +23,16 @@ namespace JsonFileKeywords
 	static constexpr const char* MinKeyword = "min";
 	static constexpr const char* MaxVelocityKeyword = "maxv";
 	static constexpr const char* MaxAccelKeyword = "maxa";
+	static constexpr const char* MaxJerkKeyword = "maxj";
+	static constexpr const char* CWLimitKeyword = "cw-limit";
+	static constexpr const char* CCWLimitKeyword = "ccw-limit";
+	static constexpr const char* TolerancesKeyword = "tolerances";
+	static constexpr const char* PathTypeKeyword = "type";
+	static constexpr const char* CartesianPathType = "cartesian";
+	static constexpr const char* JointPathType = "joint";
+	static constexpr const char* MaxStepKeyword = "max-step";
+	static constexpr const char* MinStepKeyword = "min-step";
+	static constexpr const char* MaxDeviationKeyword = "max-deviation";
+	static constexpr const char* MaxHeadingKeyword = "max-heading";
+	static constexpr const char* MaxJointStepKeyword = "max-joint-step";
 }
\ No newline at end of file
@@ -44,6 +44,14 @@ public:
 		return d;
 	}
 
+	//
+	// The angle equivalent to d, in degrees, that is closest to reference.  Used to keep a
+	// sequence of joint angles continuous instead of jumping at +/-180.
+	//
+	static double unwrapDegrees(double d, double reference) {
+		return reference + boundDegrees(d - reference);
+	}
+
 	static double BoundRadians(double r)
 	{
 		if (r > MathUtils::kPI)
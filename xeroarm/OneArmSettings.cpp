@@ -79,6 +79,39 @@ OneArmSettings::OneArmSettings(int which, const QString &title, QWidget *parent)
 	(void)connect(maxa_, &QLineEdit::editingFinished, this, &OneArmSettings::maxaChanged);
 	row++;
 
+	maxj_label_ = new QLabel("Max Jerk");
+	lay->addWidget(maxj_label_, row, 0, Qt::AlignRight);
+
+	maxj_ = new QLineEdit();
+	valid = new QDoubleValidator();
+	maxj_->setValidator(valid);
+	maxj_->setText("0.0");
+	lay->addWidget(maxj_, row, 1, Qt::AlignLeft);
+	(void)connect(maxj_, &QLineEdit::editingFinished, this, &OneArmSettings::maxjChanged);
+	row++;
+
+	cw_limit_label_ = new QLabel("CW Limit");
+	lay->addWidget(cw_limit_label_, row, 0, Qt::AlignRight);
+
+	cw_limit_ = new QLineEdit();
+	valid = new QDoubleValidator(0.0, JointDataModel::Unconstrained, 2);
+	cw_limit_->setValidator(valid);
+	cw_limit_->setText("180.0");
+	lay->addWidget(cw_limit_, row, 1, Qt::AlignLeft);
+	(void)connect(cw_limit_, &QLineEdit::editingFinished, this, &OneArmSettings::limitsChanged);
+	row++;
+
+	ccw_limit_label_ = new QLabel("CCW Limit");
+	lay->addWidget(ccw_limit_label_, row, 0, Qt::AlignRight);
+
+	ccw_limit_ = new QLineEdit();
+	valid = new QDoubleValidator(0.0, JointDataModel::Unconstrained, 2);
+	ccw_limit_->setValidator(valid);
+	ccw_limit_->setText("180.0");
+	lay->addWidget(ccw_limit_, row, 1, Qt::AlignLeft);
+	(void)connect(ccw_limit_, &QLineEdit::editingFinished, this, &OneArmSettings::limitsChanged);
+	row++;
+
 	setLayout(lay);
 }
 
@@ -93,6 +126,9 @@ void OneArmSettings::update(const JointDataModel& model)
 	initial_pos_->setText(QString::number(model.initialAngle(), 'f', 2));
 	maxv_->setText(QString::number(model.maxVelocity(), 'f', 2));
 	maxa_->setText(QString::number(model.maxAccel(), 'f', 2));
+	maxj_->setText(QString::number(model.maxJerk(), 'f', 2));
+	cw_limit_->setText(QString::number(model.cwConstraint(), 'f', 2));
+	ccw_limit_->setText(QString::number(model.ccwConstraint(), 'f', 2));
 }
 
 void OneArmSettings::lengthChanged()
@@ -119,3 +155,13 @@ void OneArmSettings::maxaChanged()
 {
 	emit settingsChanged(which_, ChangeType::MaxAccel);
 }
+
+void OneArmSettings::maxjChanged()
+{
+	emit settingsChanged(which_, ChangeType::MaxJerk);
+}
+
+void OneArmSettings::limitsChanged()
+{
+	emit settingsChanged(which_, ChangeType::JointLimits);
+}
@@ -35,6 +35,18 @@ public:
 		return maxa_->text().toDouble();
 	}
 
+	double maxJerk() {
+		return maxj_->text().toDouble();
+	}
+
+	double cwLimit() {
+		return cw_limit_->text().toDouble();
+	}
+
+	double ccwLimit() {
+		return ccw_limit_->text().toDouble();
+	}
+
 	void update(const JointDataModel& model);
 
 signals:
@@ -46,6 +58,8 @@ private:
 	void currentChanged();
 	void maxvChanged();
 	void maxaChanged();
+	void maxjChanged();
+	void limitsChanged();
 
 private:
 	static constexpr const char* AddHereText = "Add New Keepout";
@@ -71,6 +85,15 @@ private:
 	QLabel* maxa_label_;
 	QLineEdit* maxa_;
 
+	QLabel* maxj_label_;
+	QLineEdit* maxj_;
+
+	QLabel* cw_limit_label_;
+	QLineEdit* cw_limit_;
+
+	QLabel* ccw_limit_label_;
+	QLineEdit* ccw_limit_;
+
 	QString prev_text_;
 	bool is_editing_keepout_;
 };
@@ -49,6 +49,15 @@ void PathsDisplayWidget::prepareCustomMenu(const QPoint &pt)
 		act = new QAction(tr("Delete Path"));
 		connect(act, &QAction::triggered, this, &PathsDisplayWidget::deletePath);
 		menu.addAction(act);
+
+		auto path = model_.getPathByName(current_->text(0));
+		if (path != nullptr) {
+			act = new QAction(tr("Joint Space Path"));
+			act->setCheckable(true);
+			act->setChecked(path->type() == ArmPath::Type::Joint);
+			connect(act, &QAction::triggered, this, &PathsDisplayWidget::toggleJointPath);
+			menu.addAction(act);
+		}
 	}
 
 	act = new QAction(tr("Add Path"));
@@ -99,6 +108,14 @@ void PathsDisplayWidget::deletePath()
 	}
 }
 
+void PathsDisplayWidget::toggleJointPath()
+{
+	auto path = model_.getPathByName(current_->text(0));
+	if (path != nullptr) {
+		model_.setPathType(path, (path->type() == ArmPath::Type::Joint) ? ArmPath::Type::Cartesian : ArmPath::Type::Joint);
+	}
+}
+
 void PathsDisplayWidget::itemSelectionChanged()
 {
 	auto items = selectedItems();
@@ -24,6 +24,7 @@ private:
 
 	void deletePath();
 	void addPath();
+	void toggleJointPath();
 
 	QString findName();
 	void itemRenamed(QTreeWidgetItem* item, int column);
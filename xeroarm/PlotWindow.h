@@ -43,8 +43,9 @@ public:
 		return isSplitterPositionValid_;
 	}
 	void setPath(std::shared_ptr<ArmPath> path) {
-		if (path != nullptr && path->profile() != nullptr) {
-			setTrajectoryGroup(path->profile());
+		auto profile = (path != nullptr) ? path->profile() : nullptr;
+		if (profile != nullptr) {
+			setTrajectoryGroup(profile);
 		}
 	}
 
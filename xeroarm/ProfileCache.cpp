@@ -0,0 +1,37 @@
+#include "ProfileCache.h"
+#include "RobotArm.h"
+
+ProfileCache::ProfileCache(const RobotArm& arm, const ArmPath::Tolerances& tolerances)
+{
+	arm_key_ = arm.tableKey();
+	arm_pos_ = arm.pos();
+	solver_ = arm.ikSolver();
+	tolerances_ = tolerances;
+}
+
+bool ProfileCache::sameSetup(const ProfileCache& other) const
+{
+	return arm_key_ == other.arm_key_ && arm_pos_.epsilonEqual(other.arm_pos_) && solver_ == other.solver_ && tolerances_ == other.tolerances_;
+}
+
+bool ProfileCache::samePose(const Pose2d& a, const Pose2d& b)
+{
+	return a.getTranslation().epsilonEqual(b.getTranslation()) && a.getRotation().epsilonEquals(b.getRotation());
+}
+
+const ProfileCache::Segment* ProfileCache::find(int index, const Pose2d& start, const Pose2d& end) const
+{
+	//
+	// Most edits leave the segment where it was, but adding or removing a waypoint shifts
+	// the ones after it
+	//
+	if (index >= 0 && index < segments_.count() && samePose(segments_[index].start, start) && samePose(segments_[index].end, end))
+		return &segments_[index];
+
+	for (const Segment& segment : segments_) {
+		if (samePose(segment.start, start) && samePose(segment.end, end))
+			return &segment;
+	}
+
+	return nullptr;
+}
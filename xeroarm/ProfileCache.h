@@ -0,0 +1,88 @@
+#pragma once
+
+#include "Pose2d.h"
+#include "Pose2dTrajectory.h"
+#include "Translation2d.h"
+#include "ToppRA.h"
+#include "ArmPath.h"
+#include <QtCore/QString>
+#include <QtCore/QVector>
+#include <memory>
+#include <cstdint>
+
+class SplinePair;
+class RobotArm;
+
+//
+// What the profile generator worked out for a path the last time it ran, so the next run only
+// redoes the segments an edit touched.  Moving waypoint i changes the segments on either side
+// of it, i - 1 and i, and every other segment is found here by its end points.  Its joint angles
+// continue from the end of the segment before it, so a segment found here is only reused when
+// that end has not changed either.  A cache is not changed once it is built, so one generator
+// can read it while another replaces it.
+//
+class ProfileCache
+{
+public:
+	//
+	// The products for the part of the path between two waypoints
+	//
+	struct Segment
+	{
+		Pose2d start;
+		Pose2d end;
+		std::shared_ptr<SplinePair> spline;
+
+		//
+		// Samples from start to end, both included, with their joint angles, and the spline
+		// parameter of each
+		//
+		QVector<Pose2dTrajectory> samples;
+		QVector<double> params;
+
+		//
+		// The angles at the end of the segment before, which the solve for this one continued
+		// from, or nothing for a segment solved from scratch
+		//
+		QVector<double> seed;
+	};
+
+public:
+	ProfileCache(const RobotArm& arm, const ArmPath::Tolerances& tolerances);
+
+	//
+	// The samples in the cache are only good for the tolerances they were taken with, and their
+	// joint angles for the arm they were solved for
+	//
+	bool sameSetup(const ProfileCache& other) const;
+
+	const Segment* find(int index, const Pose2d& start, const Pose2d& end) const;
+
+	QVector<Segment>& segments() {
+		return segments_;
+	}
+
+	const QVector<Segment>& segments() const {
+		return segments_;
+	}
+
+	std::shared_ptr<const ToppRA> timing() const {
+		return timing_;
+	}
+
+	void setTiming(std::shared_ptr<const ToppRA> timing) {
+		timing_ = timing;
+	}
+
+private:
+	static bool samePose(const Pose2d& a, const Pose2d& b);
+
+private:
+	uint64_t arm_key_;
+	Translation2d arm_pos_;
+	QString solver_;
+	ArmPath::Tolerances tolerances_;
+
+	QVector<Segment> segments_;
+	std::shared_ptr<const ToppRA> timing_;
+};
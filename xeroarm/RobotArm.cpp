@@ -1,16 +1,200 @@
 #include "RobotArm.h"
-#include "JacobianIK.h"
+#include "IKSolverRegistry.h"
+#include "IKLookupTable.h"
 #include <Eigen/Dense>
 #include <Eigen/QR>
 
 RobotArm::RobotArm()
 {
-	inverse_ = new JacobianIK(*this);
+	updateTableKey();
+	createSolvers();
+	setIKSolver(AutomaticSolver);
+}
+
+RobotArm::RobotArm(const RobotArm& other) : pos_(other.pos_), joints_(other.joints_)
+{
+	//
+	// The solvers hold a reference to the arm they solve for, so the copy needs its own
+	//
+	table_ = other.lookupTable();
+	table_key_ = other.table_key_;
+
+	createSolvers();
+	setIKSolver(other.solver_name_);
+}
+
+void RobotArm::createSolvers()
+{
+	solvers_ = IKSolverRegistry::global().createAll(*this);
+
+	analytic_ = ikSolverByName("Analytic");
+	limits_ = ikSolverByName("Joint Limits");
+	dls_ = ikSolverByName("Damped Least Squares");
+	global_ = ikSolverByName("Annealing");
+}
+
+void RobotArm::updateTableKey()
+{
+	table_key_ = IKLookupTable::keyFor(*this);
 }
 
 RobotArm::~RobotArm()
 {
-	delete inverse_;
+	for (const QPair<QString, InverseKinematics*>& solver : solvers_) {
+		delete solver.second;
+	}
+}
+
+void RobotArm::setIKSolver(const QString& name)
+{
+	solver_name_ = name;
+	selected_ = ikSolverByName(name);
+}
+
+QStringList RobotArm::ikSolverNames() const
+{
+	QStringList ret;
+	for (const QPair<QString, InverseKinematics*>& solver : solvers_) {
+		ret.push_back(solver.first);
+	}
+
+	return ret;
+}
+
+const InverseKinematics* RobotArm::ikSolverByName(const QString& name) const
+{
+	for (const QPair<QString, InverseKinematics*>& solver : solvers_) {
+		if (solver.first == name)
+			return solver.second;
+	}
+
+	return nullptr;
+}
+
+const InverseKinematics* RobotArm::automaticSolver() const
+{
+	if (analytic_ != nullptr && analytic_->supportsArm())
+		return analytic_;
+
+	if (limits_ != nullptr && hasJointLimits())
+		return limits_;
+
+	return dls_;
+}
+
+const InverseKinematics* RobotArm::solver() const
+{
+	//
+	// Joints come and go as the arm is edited, so whether the selected solver can handle
+	// the arm is checked each time
+	//
+	if (selected_ != nullptr && selected_->supportsArm())
+		return selected_;
+
+	return automaticSolver();
+}
+
+bool RobotArm::hasCurrentLookupTable() const
+{
+	std::shared_ptr<const IKLookupTable> table = lookupTable();
+	return table != nullptr && table->key() == table_key_;
+}
+
+bool RobotArm::usesLookupTable() const
+{
+	//
+	// The closed form solver does not iterate, so a starting point buys it nothing
+	//
+	return solver() != analytic_;
+}
+
+bool RobotArm::tableSeed(const Translation2d& pt, QVector<double>& seed) const
+{
+	if (!usesLookupTable())
+		return false;
+
+	std::shared_ptr<const IKLookupTable> table = lookupTable();
+	if (table == nullptr || table->key() != table_key_)
+		return false;
+
+	return table->seed(pt - pos_, seed);
+}
+
+QVector<double> RobotArm::globalInverseKinematics(const Translation2d& pt, const QVector<double>& seed) const
+{
+	//
+	// The closed form solver finds every solution there is, so when it fails there is
+	// nothing for a search to find
+	//
+	const InverseKinematics* primary = solver();
+	if (joints_.isEmpty() || global_ == nullptr || primary == global_ || primary == analytic_)
+		return QVector<double>();
+
+	return global_->inverseKinematics(pt, seed);
+}
+
+QVector<double> RobotArm::inverseKinematics(const Translation2d& pt) const
+{
+	//
+	// There is nothing to solve for without joints, and not every solver copes with none
+	//
+	if (joints_.isEmpty())
+		return QVector<double>();
+
+	QVector<double> seed;
+
+	if (tableSeed(pt, seed))
+		return solver()->inverseKinematics(pt, seed);
+
+	return solver()->inverseKinematics(pt);
+}
+
+QVector<double> RobotArm::inverseKinematics(const Translation2d& pt, const QVector<double>& seed) const
+{
+	if (joints_.isEmpty())
+		return QVector<double>();
+
+	return solver()->inverseKinematics(pt, seed);
+}
+
+QVector<double> RobotArm::inverseKinematicsAlongPath(const Translation2d& pt, const QVector<double>& prev) const
+{
+	if (prev.isEmpty() || joints_.isEmpty())
+		return inverseKinematics(pt);
+
+	return solver()->inverseKinematicsAlongPath(pt, prev);
+}
+
+Eigen::MatrixXd RobotArm::inverseKinematicsBatch(const QVector<Translation2d>& targets, const Eigen::MatrixXd& seeds) const
+{
+	if (joints_.isEmpty())
+		return Eigen::MatrixXd(0, targets.count());
+
+	if (seeds.size() != 0 || targets.isEmpty())
+		return solver()->inverseKinematicsBatch(targets, seeds);
+
+	//
+	// Start the first target from the table.  Every target after it continues from the one
+	// before, which keeps the whole batch on one branch.
+	//
+	QVector<double> seed;
+	if (!tableSeed(targets[0], seed))
+		return solver()->inverseKinematicsBatch(targets, seeds);
+
+	Eigen::MatrixXd start(count(), 1);
+	for (int j = 0; j < count(); j++) {
+		start(j, 0) = seed[j];
+	}
+
+	return solver()->inverseKinematicsBatch(targets, start);
+}
+
+QVector<double> RobotArm::solveWithoutTable(const Translation2d& pt, const QVector<double>& prev) const
+{
+	if (prev.isEmpty())
+		return solver()->inverseKinematics(pt);
+
+	return solver()->inverseKinematicsAlongPath(pt, prev);
 }
 
 void RobotArm::setToInitialArmPos()
@@ -40,35 +224,65 @@ double RobotArm::maxArmLength() const
 	return std::accumulate(joints().begin(), joints().end(), 0.0, accum);
 }
 
-Translation2d RobotArm::jointStartPos(int joint, const QVector<double>& angles) const
+bool RobotArm::hasJointLimits() const
 {
-	Translation2d endpos = pos_;
-	double baseangle = 0.0;
+	for (const JointDataModel& joint : joints_) {
+		if (joint.isConstrained())
+			return true;
+	}
 
-	for (int i = 0; i < joint; i++) {
-		double angle = baseangle + angles[i] * M_PI / 180.0;
-		double length = joints_.at(i).length();
+	return false;
+}
 
-		endpos = Translation2d(endpos.getX() + std::cos(angle) * length, endpos.getY() + std::sin(angle) * length);
-		baseangle = angle;
+bool RobotArm::withinLimits(const QVector<double>& angles) const
+{
+	for (int i = 0; i < angles.count(); i++) {
+		if (!joints_.at(i).withinLimits(angles[i]))
+			return false;
 	}
 
-	return endpos;
+	return true;
 }
 
-Translation2d RobotArm::forwardKinematics(const QVector<double>& angles) const
+QVector<Pose2d> RobotArm::jointFrames(const QVector<double>& angles) const
 {
-	Translation2d endpos = pos_;
-	double baseangle = 0.0;
+	QVector<Pose2d> ret;
+	ret.reserve(angles.count() + 1);
+
+	//
+	// Sum the angles down the chain, so each joint costs one sin and cos of its heading and
+	// nothing has to be normalized
+	//
+	Translation2d pos = pos_;
+	Rotation2d heading;
+	double total = 0.0;
 
 	for (int i = 0; i < angles.count(); i++) {
-		double angle = baseangle + angles[i] * M_PI / 180.0;
-		double length = joints_.at(i).length();
+		total += angles[i];
+		heading = Rotation2d::fromDegrees(total);
+		ret.push_back(Pose2d(pos, heading));
+		pos = pos + Translation2d(heading, joints_.at(i).length());
+	}
+
+	ret.push_back(Pose2d(pos, heading));
+
+	return ret;
+}
 
-		endpos = Translation2d(endpos.getX() + std::cos(angle) * length, endpos.getY() + std::sin(angle) * length);
-		baseangle = angle;
+Translation2d RobotArm::jointStartPos(int joint, const QVector<double>& angles) const
+{
+	Translation2d pos = pos_;
+	double total = 0.0;
+
+	for (int i = 0; i < joint; i++) {
+		total += angles[i];
+		pos = pos + Translation2d(Rotation2d::fromDegrees(total), joints_.at(i).length());
 	}
 
-	return endpos;
+	return pos;
 }
 
+Translation2d RobotArm::forwardKinematics(const QVector<double>& angles) const
+{
+	return jointStartPos(angles.count(), angles);
+}
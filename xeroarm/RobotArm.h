@@ -3,22 +3,41 @@
 #include "InverseKinematics.h"
 #include "JointDataModel.h"
 #include "Translation2d.h"
+#include "Pose2d.h"
 #include <QtCore/QVector>
 #include <QtCore/QPointF>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+#include <QtCore/QPair>
+#include <memory>
+#include <cstdint>
+
+class IKLookupTable;
 
 
 class RobotArm
 {
+public:
+	//
+	// Closed form when the number of joints allows it, otherwise the joint limit solver if any
+	// joint is limited and damped least squares if not
+	//
+	static constexpr const char* AutomaticSolver = "Automatic";
+
 public:
 
 	RobotArm();
+	RobotArm(const RobotArm& other);
 	virtual ~RobotArm();
 
+	RobotArm& operator=(const RobotArm& other) = delete;
+
 	void setToInitialArmPos();
 	Translation2d getInitialArmPos();
 
 	void clear() {
 		joints_.clear();
+		updateTableKey();
 	}
 
 	void setJointAngle(int which, double angle) {
@@ -27,14 +46,12 @@ public:
 
 	void addJoint(const JointDataModel& model) {
 		joints_.push_back(model);
+		updateTableKey();
 	}
 
 	void replaceJoint(int which, const JointDataModel& model) {
 		joints_[which] = model;
-	}
-
-	QVector<JointDataModel>& joints() {
-		return joints_;
+		updateTableKey();
 	}
 
 	const QVector<JointDataModel>& joints() const {
@@ -58,9 +75,22 @@ public:
 	}
 
 	double maxArmLength() const;
+	bool hasJointLimits() const;
+
+	//
+	// True if every angle is within the limits of its joint
+	//
+	bool withinLimits(const QVector<double>& angles) const;
 	Translation2d forwardKinematics(const QVector<double>& angles) const;
 	Translation2d jointStartPos(int joint, const QVector<double>& angles) const;
 
+	//
+	// Forward kinematics for every joint in one pass down the chain.  Entry i is where joint i
+	// starts, with the heading of link i, and the last entry is the end effector with the
+	// heading of the last link.
+	//
+	QVector<Pose2d> jointFrames(const QVector<double>& angles) const;
+
 	QVector<double> angles() const {
 		QVector<double> ret;
 
@@ -70,10 +100,82 @@ public:
 		return ret;
 	}
 
-	QVector<double> inverseKinematics(const Translation2d& pt) const {
-		return inverse_->inverseKinematics(pt);
+	const QString& ikSolver() const {
+		return solver_name_;
+	}
+
+	//
+	// Select a solver by its registered name, or AutomaticSolver.  An unknown name, or a
+	// solver that cannot handle the arm, falls back to the automatic choice.
+	//
+	void setIKSolver(const QString& name);
+
+	QStringList ikSolverNames() const;
+	const InverseKinematics* ikSolverByName(const QString& name) const;
+
+	QVector<double> inverseKinematics(const Translation2d& pt) const;
+
+	QVector<double> inverseKinematics(const Translation2d& pt, const QVector<double>& seed) const;
+
+	QVector<double> inverseKinematicsAlongPath(const Translation2d& pt, const QVector<double>& prev) const;
+
+	QVector<double> inverseKinematics(const Translation2d& pt, const QVector<double>& seed, IKStats& stats) const {
+		return solver()->inverseKinematics(pt, seed, stats);
+	}
+
+	Eigen::MatrixXd inverseKinematicsBatch(const QVector<Translation2d>& targets, const Eigen::MatrixXd& seeds = Eigen::MatrixXd()) const;
+
+	//
+	// The global search, for a target the selected solver failed to reach.  It can take up to a
+	// tenth of a second, so the solves above never fall back to it on their own, and the caller
+	// decides how much time to spend on it.  Returns nothing when the selected solver is the
+	// search itself, or the closed form solver, which already finds every solution there is.
+	//
+	QVector<double> globalInverseKinematics(const Translation2d& pt, const QVector<double>& seed) const;
+
+	QVector<QVector<double>> inverseKinematicsSolutions(const Pose2d& pose) const {
+		return solver()->solutions(pose);
+	}
+
+	//
+	// Solve without consulting the lookup table, used to fill in the table itself
+	//
+	QVector<double> solveWithoutTable(const Translation2d& pt, const QVector<double>& prev) const;
+
+	//
+	// The precomputed solutions used to seed the iterative solvers.  The table is ignored if
+	// it was built for a different set of joints.
+	//
+	std::shared_ptr<const IKLookupTable> lookupTable() const {
+		return std::atomic_load(&table_);
+	}
+
+	void setLookupTable(std::shared_ptr<const IKLookupTable> table) {
+		std::atomic_store(&table_, table);
+	}
+
+	bool hasCurrentLookupTable() const;
+
+	//
+	// False when the solver in use takes no starting point, so a table would go unused
+	//
+	bool usesLookupTable() const;
+
+	//
+	// IKLookupTable::keyFor the joints as they are now, worked out when the joints change
+	// rather than on every solve
+	//
+	uint64_t tableKey() const {
+		return table_key_;
 	}
 
+private:
+	void createSolvers();
+	void updateTableKey();
+	const InverseKinematics* solver() const;
+	const InverseKinematics* automaticSolver() const;
+	bool tableSeed(const Translation2d& pt, QVector<double>& seed) const;
+
 private:
 
 	//
@@ -87,8 +189,29 @@ private:
 	QVector<JointDataModel> joints_;
 
 	//
-	// The inverse kinematics used for the ARM
+	// The name of the inverse kinematics solver used for the ARM
+	//
+	QString solver_name_;
+
+	//
+	// One of each registered inverse kinematics solver, and the ones the automatic choice
+	// picks between
+	//
+	QVector<QPair<QString, InverseKinematics*>> solvers_;
+	const InverseKinematics* selected_;
+	const InverseKinematics* analytic_;
+	const InverseKinematics* limits_;
+	const InverseKinematics* dls_;
+
+	//
+	// The global search for targets the selected solver fails to reach
+	//
+	const InverseKinematics* global_;
+
+	//
+	// Solutions covering the workspace, shared with the thread that builds it
 	//
-	InverseKinematics* inverse_;
+	std::shared_ptr<const IKLookupTable> table_;
+	uint64_t table_key_;
 
 };
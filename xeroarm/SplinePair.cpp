@@ -14,6 +14,7 @@
 // limitations under the License.
 //
 #include "SplinePair.h"
+#include <algorithm>
 #include <cmath>
 
 SplinePair::SplinePair(const Pose2d &p0, const Pose2d &p1)
@@ -39,6 +40,8 @@ SplinePair::SplinePair(const Pose2d &p0, const Pose2d &p1)
 
 	has_step_ = false;
 	step_ = 0.1;
+
+	buildArcTable();
 }
 
 SplinePair::SplinePair(const QuinticHermiteSpline& x, const QuinticHermiteSpline& y)
@@ -48,6 +51,8 @@ SplinePair::SplinePair(const QuinticHermiteSpline& x, const QuinticHermiteSpline
 
 	has_step_ = false;
 	step_ = 0.1;
+
+	buildArcTable();
 }
 
 SplinePair::~SplinePair()
@@ -100,3 +105,96 @@ Pose2d SplinePair::getEndPose()
 {
 	return Pose2d(evalPosition(1), evalHeading(1));
 }
+
+double SplinePair::integrate(double t0, double t1)
+{
+	//
+	// Five point Gauss-Legendre quadrature of the speed.  The speed of a quintic is smooth, so
+	// over one table interval this is accurate to rounding.
+	//
+	static constexpr const double nodes[] = { 0.0, -0.5384693101056831, 0.5384693101056831, -0.9061798459386640, 0.9061798459386640 };
+	static constexpr const double weights[] = { 0.5688888888888889, 0.4786286704993665, 0.4786286704993665, 0.2369268850561891, 0.2369268850561891 };
+
+	double half = (t1 - t0) / 2.0;
+	double mid = (t0 + t1) / 2.0;
+	double sum = 0.0;
+
+	for (int i = 0; i < 5; i++) {
+		sum += weights[i] * speed(mid + half * nodes[i]);
+	}
+
+	return sum * half;
+}
+
+void SplinePair::buildArcTable()
+{
+	arc_.resize(kArcIntervals + 1);
+	inverse_.resize(kArcIntervals + 1);
+
+	arc_[0] = 0.0;
+	for (int i = 0; i < kArcIntervals; i++) {
+		arc_[i + 1] = arc_[i] + integrate(static_cast<double>(i) / kArcIntervals, static_cast<double>(i + 1) / kArcIntervals);
+	}
+	length_ = arc_[kArcIntervals];
+
+	//
+	// The distance only grows with t, so walk both tables together
+	//
+	inverse_[0] = 0.0;
+	inverse_[kArcIntervals] = 1.0;
+
+	int piece = 0;
+	for (int k = 1; k < kArcIntervals; k++) {
+		double target = length_ * k / kArcIntervals;
+		while (piece < kArcIntervals - 1 && arc_[piece + 1] < target)
+			piece++;
+
+		double span = arc_[piece + 1] - arc_[piece];
+		double t = (piece + ((span > 0.0) ? (target - arc_[piece]) / span : 0.0)) / kArcIntervals;
+		inverse_[k] = solveDistance(target, t, static_cast<double>(piece) / kArcIntervals, static_cast<double>(piece + 1) / kArcIntervals);
+	}
+}
+
+double SplinePair::solveDistance(double dist, double t, double lo, double hi)
+{
+	//
+	// Newton's method, the derivative of the distance being the speed, kept inside a range
+	// known to hold the answer
+	//
+	for (int i = 0; i < 3; i++) {
+		double error = distance(t) - dist;
+		double v = speed(t);
+		if (std::fabs(error) <= 1.0e-12 * length_ || v <= 0.0)
+			break;
+
+		t = std::min(std::max(t - error / v, lo), hi);
+	}
+
+	return t;
+}
+
+double SplinePair::distance(double t)
+{
+	t = std::min(std::max(t, 0.0), 1.0);
+
+	int piece = std::min(static_cast<int>(t * kArcIntervals), kArcIntervals - 1);
+	return arc_[piece] + integrate(static_cast<double>(piece) / kArcIntervals, t);
+}
+
+double SplinePair::paramAtDistance(double dist)
+{
+	if (length_ <= 0.0)
+		return 0.0;
+
+	dist = std::min(std::max(dist, 0.0), length_);
+
+	//
+	// Start from the inverse table and polish the guess
+	//
+	double where = dist / length_ * kArcIntervals;
+	int piece = std::min(static_cast<int>(where), kArcIntervals - 1);
+	double lo = inverse_[piece];
+	double hi = inverse_[piece + 1];
+
+	return solveDistance(dist, lo + (where - piece) * (hi - lo), lo, hi);
+}
@@ -20,6 +20,7 @@
 #include "Pose2d.h"
 #include <memory>
 #include <vector>
+#include <cmath>
 
 class SplinePair
 {
@@ -53,11 +54,13 @@ public:
 	void ddxy0(double x, double y) {
 		x_->ddv0(x);
 		y_->ddv0(y);
+		buildArcTable();
 	}
 
 	void ddxy1(double x, double y) {
 		x_->ddv1(x);
 		y_->ddv1(y);
+		buildArcTable();
 	}
 
 	Translation2d evalPosition(double t);
@@ -71,6 +74,18 @@ public:
 	Pose2d getStartPose();
 	Pose2d getEndPose();
 
+	//
+	// The length of the spline, the distance along it from the start to t, and the t at a
+	// given distance along it.  The distances are integrated when the spline is built and kept
+	// in tables, so each of these takes the same small amount of work wherever it is asked.
+	//
+	double length() const {
+		return length_;
+	}
+
+	double distance(double t);
+	double paramAtDistance(double dist);
+
 	double sumDCurvature2() {
 		double dt = 1.0 / kSamples;
 		double sum = 0;
@@ -123,13 +138,34 @@ private:
 		return y_->derivative3(t);
 	}
 
+	double speed(double t) {
+		return std::sqrt(dx(t) * dx(t) + dy(t) * dy(t));
+	}
+
+	double integrate(double t0, double t1);
+	double solveDistance(double dist, double t, double lo, double hi);
+	void buildArcTable();
+
 private:
 	static constexpr int kSamples = 100;
 
+	//
+	// The number of equal pieces, in t and in distance, the arc length tables split the spline into
+	//
+	static constexpr int kArcIntervals = 64;
+
 private:
 	QuinticHermiteSpline* x_;
 	QuinticHermiteSpline* y_;
 	bool has_step_;
 	double step_;
+
+	//
+	// The distance along the spline at t = i / kArcIntervals, and the t at a distance of
+	// i / kArcIntervals of the length
+	//
+	std::vector<double> arc_;
+	std::vector<double> inverse_;
+	double length_;
 };
 
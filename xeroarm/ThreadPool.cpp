@@ -0,0 +1,118 @@
+#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+
+ThreadPool::ThreadPool(int threads)
+{
+	if (threads <= 0)
+		threads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+
+	running_ = true;
+	for (int i = 0; i < threads; i++) {
+		threads_.push_back(std::thread(&ThreadPool::threadFunction, this));
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard guard(queue_lock_);
+		running_ = false;
+	}
+	queue_cv_.notify_all();
+
+	for (std::thread& th : threads_) {
+		th.join();
+	}
+}
+
+ThreadPool& ThreadPool::global()
+{
+	static ThreadPool pool;
+	return pool;
+}
+
+void ThreadPool::post(std::function<void()> job)
+{
+	{
+		std::lock_guard guard(queue_lock_);
+		queue_.push_back(std::move(job));
+	}
+	queue_cv_.notify_one();
+}
+
+void ThreadPool::threadFunction()
+{
+	while (true)
+	{
+		std::function<void()> job;
+		{
+			std::unique_lock guard(queue_lock_);
+			queue_cv_.wait(guard, [this] { return !running_ || !queue_.empty(); });
+
+			if (!running_ && queue_.empty())
+				break;
+
+			job = std::move(queue_.front());
+			queue_.pop_front();
+		}
+
+		job();
+	}
+}
+
+void ThreadPool::parallelFor(int count, const std::function<void(int)>& fn)
+{
+	struct State
+	{
+		std::atomic<int> next{ 0 };
+		std::atomic<int> done{ 0 };
+		std::mutex lock;
+		std::condition_variable cv;
+		std::exception_ptr error;
+	};
+
+	if (count <= 0)
+		return;
+
+	auto state = std::make_shared<State>();
+	int total = count;
+
+	//
+	// Helpers that start after all of the work has been handed out find nothing left
+	// and never touch fn, which may be gone by then
+	//
+	auto work = [state, total, &fn]() {
+		int i;
+		while ((i = state->next++) < total) {
+			try {
+				fn(i);
+			}
+			catch (...) {
+				std::lock_guard guard(state->lock);
+				if (!state->error)
+					state->error = std::current_exception();
+			}
+
+			if (++state->done == total) {
+				std::lock_guard guard(state->lock);
+				state->cv.notify_all();
+			}
+		}
+	};
+
+	int helpers = std::min(threadCount(), count - 1);
+	for (int i = 0; i < helpers; i++) {
+		post(work);
+	}
+
+	work();
+
+	std::unique_lock guard(state->lock);
+	state->cv.wait(guard, [&state, total] { return state->done == total; });
+
+	if (state->error)
+		std::rethrow_exception(state->error);
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <functional>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+//
+// A fixed set of worker threads that run jobs posted to a shared queue
+//
+class ThreadPool
+{
+public:
+	ThreadPool(int threads = 0);
+	virtual ~ThreadPool();
+
+	int threadCount() const {
+		return static_cast<int>(threads_.size());
+	}
+
+	void post(std::function<void()> job);
+
+	//
+	// Run fn(i) for every i in [0, count) spread across the pool and wait for all of them
+	// to finish.  The calling thread works through the indexes as well, so this can be called
+	// from a job that is already running on the pool without waiting on itself.
+	//
+	void parallelFor(int count, const std::function<void(int)>& fn);
+
+	//
+	// The pool shared by everything that just needs to spread work across the cores
+	//
+	static ThreadPool& global();
+
+private:
+	void threadFunction();
+
+private:
+	std::mutex queue_lock_;
+	std::condition_variable queue_cv_;
+	std::deque<std::function<void()>> queue_;
+	std::vector<std::thread> threads_;
+	bool running_;
+};
@@ -0,0 +1,475 @@
+#include "ToppRA.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+ToppRA::ToppRA(const QVector<double>& maxVelocity, const QVector<double>& maxAccel)
+{
+	max_velocity_ = maxVelocity;
+	max_accel_ = maxAccel;
+	solved_ = 0;
+}
+
+void ToppRA::setMaxJerk(const QVector<double>& maxJerk)
+{
+	max_jerk_ = maxJerk;
+}
+
+bool ToppRA::jerkLimited() const
+{
+	for (double jerk : max_jerk_) {
+		if (jerk > 0.0)
+			return true;
+	}
+
+	return false;
+}
+
+bool ToppRA::near(double a, double b)
+{
+	return std::fabs(a - b) <= 1.0e-9 * std::max({ 1.0, std::fabs(a), std::fabs(b) });
+}
+
+bool ToppRA::cancelled(int station) const
+{
+	return cancelled_ && station % cancelInterval == 0 && cancelled_();
+}
+
+bool ToppRA::sameStation(int station, const ToppRA& other, int otherStation) const
+{
+	if (!near(ds_[station], other.ds_[otherStation]))
+		return false;
+
+	for (int j = 0; j < dq_[station].count(); j++) {
+		if (!near(dq_[station][j], other.dq_[otherStation][j]) || !near(ddq_[station][j], other.ddq_[otherStation][j]))
+			return false;
+	}
+
+	return true;
+}
+
+QVector<int> ToppRA::matchStations(const ToppRA& other) const
+{
+	//
+	// An edit changes a stretch of the path and may add or remove stations there, so the
+	// stations before it line up one for one and the stations after it line up counting from
+	// the end.  Anything else has no counterpart.
+	//
+	const int n = ds_.count();
+	const int m = other.ds_.count();
+	QVector<int> ret(n, -1);
+
+	int prefix = 0;
+	while (prefix < n && prefix < m && sameStation(prefix, other, prefix)) {
+		ret[prefix] = prefix;
+		prefix++;
+	}
+
+	//
+	// The last station has no step after it, and in the old path the station that took its
+	// place may have, so the steps are compared from the next to last station back
+	//
+	if (n > 0 && m > 0 && ret[n - 1] < 0 && sameStation(n - 1, other, m - 1))
+		ret[n - 1] = m - 1;
+
+	for (int k = n - 2, o = m - 2; k >= prefix && o >= prefix && ret[k + 1] == o + 1 && sameStation(k, other, o); k--, o--) {
+		ret[k] = o;
+	}
+
+	return ret;
+}
+
+double ToppRA::jointVelocity(int station, int joint) const
+{
+	return dq_[station][joint] * velocity_[station];
+}
+
+double ToppRA::jointAcceleration(int station, int joint) const
+{
+	return dq_[station][joint] * accel_[station] + ddq_[station][joint] * x_[station];
+}
+
+void ToppRA::derivatives(const QVector<double>& stations, const QVector<QVector<double>>& angles)
+{
+	const int n = stations.count();
+	const int joints = max_velocity_.count();
+
+	ds_.resize(n);
+	dq_.fill(QVector<double>(joints, 0.0), n);
+	ddq_.fill(QVector<double>(joints, 0.0), n);
+
+	for (int k = 0; k < n - 1; k++) {
+		ds_[k] = stations[k + 1] - stations[k];
+	}
+	ds_[n - 1] = 0.0;
+
+	//
+	// Central differences inside the path and one sided differences at the ends.  The second
+	// derivative at each end is taken from the station next to it.
+	//
+	for (int k = 0; k < n; k++) {
+		int prev = std::max(k - 1, 0);
+		int next = std::min(k + 1, n - 1);
+
+		for (int j = 0; j < joints; j++) {
+			dq_[k][j] = (angles[next][j] - angles[prev][j]) / (stations[next] - stations[prev]);
+
+			if (k > 0 && k < n - 1) {
+				double h0 = stations[k] - stations[k - 1];
+				double h1 = stations[k + 1] - stations[k];
+				double slope0 = (angles[k][j] - angles[k - 1][j]) / h0;
+				double slope1 = (angles[k + 1][j] - angles[k][j]) / h1;
+				ddq_[k][j] = 2.0 * (slope1 - slope0) / (h0 + h1);
+			}
+		}
+	}
+
+	if (n >= 3) {
+		ddq_[0] = ddq_[1];
+		ddq_[n - 1] = ddq_[n - 2];
+	}
+}
+
+void ToppRA::stationConstraints(int station, QVector<Constraint>& constraints) const
+{
+	//
+	// The joint velocities cap x directly, the joint accelerations bound a line in x and u
+	//
+	double xmax = maxPathVelocity * maxPathVelocity;
+
+	for (int j = 0; j < max_velocity_.count(); j++) {
+		double dq = dq_[station][j];
+		double ddq = ddq_[station][j];
+
+		if (std::fabs(dq) > std::numeric_limits<double>::epsilon()) {
+			double v = max_velocity_[j] / std::fabs(dq);
+			xmax = std::min(xmax, v * v);
+		}
+
+		constraints.push_back({ ddq, dq, max_accel_[j] });
+		constraints.push_back({ -ddq, -dq, max_accel_[j] });
+	}
+
+	constraints.push_back({ -1.0, 0.0, 0.0 });
+	constraints.push_back({ 1.0, 0.0, std::max(std::min(xmax, cap_[station]), 0.0) });
+}
+
+bool ToppRA::feasibleRange(const QVector<Constraint>& constraints, double& lo, double& hi)
+{
+	//
+	// A linear program in two variables has its optimum at a corner of the feasible region, and
+	// there are only a handful of constraints, so try every corner
+	//
+	lo = std::numeric_limits<double>::max();
+	hi = -std::numeric_limits<double>::max();
+
+	for (int i = 0; i < constraints.count(); i++) {
+		for (int j = i + 1; j < constraints.count(); j++) {
+			const Constraint& ci = constraints[i];
+			const Constraint& cj = constraints[j];
+
+			double det = ci.a * cj.b - cj.a * ci.b;
+			if (std::fabs(det) < 1.0e-12)
+				continue;
+
+			double x = (ci.c * cj.b - cj.c * ci.b) / det;
+			double u = (ci.a * cj.c - cj.a * ci.c) / det;
+
+			bool feasible = true;
+			for (const Constraint& c : constraints) {
+				double lhs = c.a * x + c.b * u;
+				double tolerance = 1.0e-9 * std::max({ 1.0, std::fabs(c.c), std::fabs(c.a * x) + std::fabs(c.b * u) });
+				if (lhs > c.c + tolerance) {
+					feasible = false;
+					break;
+				}
+			}
+
+			if (feasible) {
+				lo = std::min(lo, x);
+				hi = std::max(hi, x);
+			}
+		}
+	}
+
+	if (lo > hi)
+		return false;
+
+	lo = std::max(lo, 0.0);
+	hi = std::max(hi, lo);
+	return true;
+}
+
+bool ToppRA::accelRange(const QVector<Constraint>& constraints, double x, double& lo, double& hi)
+{
+	lo = -std::numeric_limits<double>::max();
+	hi = std::numeric_limits<double>::max();
+
+	for (const Constraint& c : constraints) {
+		double rest = c.c - c.a * x;
+
+		if (std::fabs(c.b) < 1.0e-12) {
+			if (rest < -1.0e-9 * std::max(1.0, std::fabs(c.c)))
+				return false;
+		}
+		else if (c.b > 0.0) {
+			hi = std::min(hi, rest / c.b);
+		}
+		else {
+			lo = std::max(lo, rest / c.b);
+		}
+	}
+
+	return lo <= hi + 1.0e-9 * std::max(1.0, std::fabs(hi));
+}
+
+bool ToppRA::solve(const QVector<double>& stations, const QVector<QVector<double>>& angles)
+{
+	return solve(stations, angles, nullptr);
+}
+
+bool ToppRA::solve(const QVector<double>& stations, const QVector<QVector<double>>& angles, const ToppRA* previous)
+{
+	const int n = stations.count();
+	solved_ = 0;
+
+	velocity_.clear();
+	accel_.clear();
+	time_.clear();
+
+	if (n < 2 || angles.count() != n || max_accel_.count() != max_velocity_.count())
+		return false;
+
+	for (int k = 0; k < n; k++) {
+		if (angles[k].count() != max_velocity_.count())
+			return false;
+
+		if (k > 0 && stations[k] <= stations[k - 1])
+			return false;
+	}
+
+	derivatives(stations, angles);
+
+	//
+	// The jerk passes change the ranges all along the path, so nothing can be reused when the
+	// jerk is limited
+	//
+	QVector<int> match(n, -1);
+	if (previous != nullptr && previous->count() > 0 && previous->max_velocity_ == max_velocity_ && previous->max_accel_ == max_accel_ && previous->max_jerk_ == max_jerk_ && !jerkLimited())
+		match = matchStations(*previous);
+
+	cap_.fill(maxPathVelocity * maxPathVelocity, n);
+	lo_.fill(0.0, n);
+	hi_.fill(0.0, n);
+
+	for (int pass = 0; ; pass++) {
+		if (!backwardSweep(match, previous))
+			return false;
+
+		QVector<int> violations;
+		if (!forwardSweep(match, previous, violations))
+			return false;
+
+		if (violations.isEmpty())
+			break;
+
+		//
+		// A profile that breaks the jerk limits is no better than no profile at all
+		//
+		if (pass == maxJerkPasses) {
+			accel_.clear();
+			return false;
+		}
+
+		//
+		// The arm reached these stations too fast to change its acceleration in time.  Lower
+		// the speed allowed on the way in and try again.
+		//
+		for (int k : violations) {
+			for (int i = std::max(0, k - jerkBackoff); i <= k; i++) {
+				cap_[i] = std::min(cap_[i], x_[i] * jerkShrink);
+			}
+		}
+	}
+
+	//
+	// The acceleration is constant between stations, so the time for each step is its length
+	// over the average of the velocities at either end
+	//
+	velocity_.resize(n);
+	time_.resize(n);
+
+	for (int k = 0; k < n; k++) {
+		velocity_[k] = std::sqrt(x_[k]);
+	}
+
+	time_[0] = 0.0;
+	for (int k = 0; k < n - 1; k++) {
+		double v = velocity_[k] + velocity_[k + 1];
+		if (v <= 0.0) {
+			velocity_.clear();
+			accel_.clear();
+			time_.clear();
+			return false;
+		}
+
+		time_[k + 1] = time_[k] + 2.0 * ds_[k] / v;
+	}
+
+	return true;
+}
+
+bool ToppRA::backwardSweep(const QVector<int>& match, const ToppRA* previous)
+{
+	//
+	// The arm must be at rest at the last station, and at every other station x must satisfy
+	// the joint limits with some u that lands inside the range for the next one
+	//
+	const int n = ds_.count();
+	lo_[n - 1] = 0.0;
+	hi_[n - 1] = 0.0;
+
+	for (int k = n - 2; k >= 0; k--) {
+		if (cancelled(k))
+			return false;
+
+		//
+		// Same station, same range for the next station, same range for this one
+		//
+		if (match[k] >= 0 && match[k + 1] == match[k] + 1 && near(lo_[k + 1], previous->lo_[match[k + 1]]) && near(hi_[k + 1], previous->hi_[match[k + 1]])) {
+			lo_[k] = previous->lo_[match[k]];
+			hi_[k] = previous->hi_[match[k]];
+			continue;
+		}
+
+		solved_++;
+
+		QVector<Constraint> constraints;
+		stationConstraints(k, constraints);
+		constraints.push_back({ 1.0, 2.0 * ds_[k], hi_[k + 1] });
+		constraints.push_back({ -1.0, -2.0 * ds_[k], -lo_[k + 1] });
+
+		//
+		// Staying at rest is always possible, so an empty range is only rounding
+		//
+		if (!feasibleRange(constraints, lo_[k], hi_[k])) {
+			lo_[k] = 0.0;
+			hi_[k] = 0.0;
+		}
+	}
+
+	return true;
+}
+
+void ToppRA::jerkConstraints(int station, double dt, QVector<Constraint>& constraints) const
+{
+	//
+	// Each joint acceleration may only move from where it was at the last station by as much
+	// as the jerk limit allows over the time between them.  The arm starts at rest with no
+	// acceleration.
+	//
+	for (int j = 0; j < max_jerk_.count(); j++) {
+		if (max_jerk_[j] <= 0.0)
+			continue;
+
+		double prev = (station > 0) ? jointAcceleration(station - 1, j) : 0.0;
+		double room = max_jerk_[j] * dt;
+		double dq = dq_[station][j];
+		double ddq = ddq_[station][j];
+
+		constraints.push_back({ ddq, dq, prev + room });
+		constraints.push_back({ -ddq, -dq, room - prev });
+	}
+}
+
+bool ToppRA::forwardSweep(const QVector<int>& match, const ToppRA* previous, QVector<int>& violations)
+{
+	//
+	// Start at rest and take the largest acceleration that keeps the next station
+	// controllable, and that the jerk limits allow where that is possible
+	//
+	const int n = ds_.count();
+	x_.fill(0.0, n);
+	accel_.fill(0.0, n);
+
+	for (int k = 0; k < n - 1; k++) {
+		if (cancelled(k))
+			return false;
+
+		int m = match[k];
+		if (m >= 0 && match[k + 1] == m + 1 && near(x_[k], previous->x_[m]) && near(lo_[k + 1], previous->lo_[m + 1]) && near(hi_[k + 1], previous->hi_[m + 1])) {
+			accel_[k] = previous->accel_[m];
+			x_[k + 1] = previous->x_[m + 1];
+			continue;
+		}
+
+		solved_++;
+
+		QVector<Constraint> constraints;
+		stationConstraints(k, constraints);
+		constraints.push_back({ 1.0, 2.0 * ds_[k], hi_[k + 1] });
+		constraints.push_back({ -1.0, -2.0 * ds_[k], -lo_[k + 1] });
+
+		double ulo, uhi;
+		bool reachable = accelRange(constraints, x_[k], ulo, uhi);
+
+		if (reachable && jerkLimited()) {
+			//
+			// The jerk is measured over the time of the step before, except on the first step
+			// where there is none and the time of the step itself is used.  That depends on the
+			// acceleration chosen, so settle it by repeating.
+			//
+			double v = std::sqrt(x_[k]);
+			double dt = (k > 0) ? stepTime(k - 1) : 0.0;
+			int tries = (k > 0) ? 1 : 4;
+
+			for (int i = 0; i < tries; i++) {
+				if (k == 0)
+					dt = 2.0 * ds_[k] / (v + std::sqrt(std::max(x_[k] + 2.0 * ds_[k] * uhi, 0.0)));
+
+				QVector<Constraint> limited = constraints;
+				jerkConstraints(k, dt, limited);
+
+				double jlo, jhi;
+				if (!accelRange(limited, x_[k], jlo, jhi)) {
+					violations.push_back(k);
+					break;
+				}
+
+				uhi = jhi;
+			}
+		}
+
+		double next;
+		if (reachable)
+			next = x_[k] + 2.0 * ds_[k] * uhi;
+		else
+			next = x_[k];
+
+		next = std::min(std::max(next, lo_[k + 1]), hi_[k + 1]);
+		accel_[k] = (next - x_[k]) / (2.0 * ds_[k]);
+		x_[k + 1] = next;
+	}
+
+	//
+	// The arm ends at rest with no acceleration, just as it starts, so the joint accelerations
+	// on the last step must be able to drop to zero in the time the step takes
+	//
+	if (jerkLimited() && n >= 2) {
+		double dt = stepTime(n - 2);
+		for (int j = 0; j < max_jerk_.count(); j++) {
+			if (max_jerk_[j] > 0.0 && std::fabs(jointAcceleration(n - 2, j)) > max_jerk_[j] * dt * (1.0 + 1.0e-9)) {
+				violations.push_back(n - 1);
+				break;
+			}
+		}
+	}
+
+	return true;
+}
+
+double ToppRA::stepTime(int step) const
+{
+	double v = std::sqrt(x_[step]) + std::sqrt(x_[step + 1]);
+	return (v > 0.0) ? 2.0 * ds_[step] / v : 0.0;
+}
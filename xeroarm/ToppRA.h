@@ -0,0 +1,166 @@
+#pragma once
+
+#include <QtCore/QVector>
+#include <functional>
+
+//
+// Time optimal parameterization of a path by reachability analysis (TOPP-RA).  The path is given
+// as joint angles at a series of stations along a path parameter s, and every joint has a maximum
+// velocity and acceleration.  Working in x = (ds/dt)^2 and u = d2s/dt2, the joint limits become
+// linear constraints at each station,
+//
+//     |q'(s)| sqrt(x) <= vmax      and      |q'(s) u + q''(s) x| <= amax
+//
+// and moving to the next station is x(k+1) = x(k) + 2 u(k) ds.  A backward sweep finds, for each
+// station, the range of x from which the arm can still come to rest at the end of the path, each
+// range the solution of a small linear program in x and u.  A forward sweep then takes the
+// largest acceleration at each station that stays inside the next range, which gives the time
+// optimal profile.  Both sweeps are linear in the number of stations.
+//
+// Given the solution for an earlier version of the same path, only the stations around the
+// part that changed are solved again.  The backward sweep copies the ranges after the change
+// and stops solving before it once a range comes out the same as last time, and the forward
+// sweep does the same in the other direction.
+//
+class ToppRA
+{
+public:
+	ToppRA(const QVector<double>& maxVelocity, const QVector<double>& maxAccel);
+
+	//
+	// Parameterize the path.  The stations must be increasing and there must be one set of
+	// joint angles, in degrees, per station.  The profile starts and ends at rest.  Returns
+	// false if the input is not a path this can parameterize.
+	//
+	bool solve(const QVector<double>& stations, const QVector<QVector<double>>& angles);
+
+	//
+	// The same, reusing what it can from the solution for an earlier version of the path.  The
+	// previous solution is ignored if it was solved for different joint limits.
+	//
+	bool solve(const QVector<double>& stations, const QVector<QVector<double>>& angles, const ToppRA* previous);
+
+	//
+	// Limit how fast each joint acceleration may change, in degrees per second cubed.  A limit
+	// of zero or less leaves the joint unlimited.  The jerk is not a linear constraint in x and
+	// u, so it is applied in the forward sweep.  Where the arm arrives at a station too fast to
+	// meet it, the speed allowed on the way in is lowered and both sweeps run again.  If the
+	// limits are still missed after maxJerkPasses, solve returns false.
+	//
+	void setMaxJerk(const QVector<double>& maxJerk);
+	bool jerkLimited() const;
+
+	//
+	// The number of linear programs the last solve worked through, less the ones it reused
+	//
+	int solvedStations() const {
+		return solved_;
+	}
+
+	//
+	// Checked every so often during a solve, which gives up and returns false once it is true
+	//
+	void setCancel(std::function<bool()> cancelled) {
+		cancelled_ = cancelled;
+	}
+
+	int count() const {
+		return velocity_.count();
+	}
+
+	//
+	// ds/dt, d2s/dt2 and the time at each station.  The acceleration at a station holds until
+	// the next station.
+	//
+	double velocity(int station) const {
+		return velocity_[station];
+	}
+
+	double acceleration(int station) const {
+		return accel_[station];
+	}
+
+	double time(int station) const {
+		return time_[station];
+	}
+
+	//
+	// Joint velocity and acceleration at each station, in degrees per second and per second squared
+	//
+	double jointVelocity(int station, int joint) const;
+	double jointAcceleration(int station, int joint) const;
+
+public:
+	//
+	// The fastest the path parameter may move where no joint moves with it
+	//
+	static constexpr const double maxPathVelocity = 1000000.0;
+
+	//
+	// How many times the sweeps are repeated to meet the jerk limits, how many stations before
+	// one that misses them have their speed lowered, and by how much
+	//
+	static constexpr const int maxJerkPasses = 50;
+	static constexpr const int jerkBackoff = 4;
+	static constexpr const double jerkShrink = 0.9;
+
+private:
+	//
+	// The half plane a * x + b * u <= c
+	//
+	struct Constraint
+	{
+		double a;
+		double b;
+		double c;
+	};
+
+	void derivatives(const QVector<double>& stations, const QVector<QVector<double>>& angles);
+	void stationConstraints(int station, QVector<Constraint>& constraints) const;
+	void jerkConstraints(int station, double dt, QVector<Constraint>& constraints) const;
+	bool backwardSweep(const QVector<int>& match, const ToppRA* previous);
+	bool forwardSweep(const QVector<int>& match, const ToppRA* previous, QVector<int>& violations);
+	double stepTime(int step) const;
+	bool sameStation(int station, const ToppRA& other, int otherStation) const;
+	QVector<int> matchStations(const ToppRA& other) const;
+	static bool near(double a, double b);
+	bool cancelled(int station) const;
+	static bool feasibleRange(const QVector<Constraint>& constraints, double& lo, double& hi);
+	static bool accelRange(const QVector<Constraint>& constraints, double x, double& lo, double& hi);
+
+private:
+	QVector<double> max_velocity_;
+	QVector<double> max_accel_;
+	QVector<double> max_jerk_;
+
+	//
+	// Per station, the first and second derivative of each joint angle with respect to s
+	//
+	QVector<QVector<double>> dq_;
+	QVector<QVector<double>> ddq_;
+	QVector<double> ds_;
+
+	//
+	// Per station, the controllable range of x from the backward sweep
+	//
+	QVector<double> lo_;
+	QVector<double> hi_;
+
+	//
+	// Per station, the most x may be, lowered where the arm cannot meet the jerk limits
+	//
+	QVector<double> cap_;
+
+	QVector<double> x_;
+	QVector<double> velocity_;
+	QVector<double> accel_;
+	QVector<double> time_;
+	int solved_;
+
+	std::function<bool()> cancelled_;
+
+	//
+	// How many stations to work through between checks for cancellation
+	//
+	static constexpr const int cancelInterval = 64;
+};
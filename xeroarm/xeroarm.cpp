@@ -1,4 +1,5 @@
 #include "xeroarm.h"
+#include "IKBenchmark.h"
 #include <QtCore/QCoreApplication>
 #include <QtWidgets/QMenuBar>
 #include <QtWidgets/QDockWidget>
@@ -8,7 +9,7 @@
 #include <QtGui/QActionGroup>
 #include <QtGui/QCloseEvent>
 
-xeroarm::xeroarm(QWidget *parent) : QMainWindow(parent)
+xeroarm::xeroarm(QWidget *parent) : QMainWindow(parent), pool_(1)
 {
 	createWindows();
 	createMenus();
@@ -61,10 +62,11 @@ xeroarm::xeroarm(QWidget *parent) : QMainWindow(parent)
 	status_text_ = new QLabel("Idle");
 	statusBar()->addWidget(status_text_);
 
-	ik_type_text_ = new QLabel("Jacobian");
+	ik_type_text_ = new QLabel(RobotArm::AutomaticSolver);
 	statusBar()->addPermanentWidget(ik_type_text_);
 
 	(void)connect(&model_, &ArmDataModel::progress, this, &xeroarm::progress);
+	(void)connect(this, &xeroarm::benchmarkFinished, this, &xeroarm::showBenchmark);
 	(void)connect(central_, &CentralWidget::mouseMove, this, &xeroarm::mouseMove);
 	(void)connect(central_, &CentralWidget::changeTime, this, &xeroarm::timeChange);
 }
@@ -181,10 +183,23 @@ void xeroarm::createMenus()
 	menuBar()->addMenu(ik_type_);
 	ik_type_group_ = new QActionGroup(this);
 
-	ik_jacobian_ = ik_type_->addAction("Jacobian");
-	ik_jacobian_->setCheckable(true);
-	connect(ik_jacobian_, &QAction::triggered, this, &xeroarm::setIKJacobian);
-	ik_type_group_->addAction(ik_jacobian_);
+	//
+	// One entry for the automatic choice and one per registered solver
+	//
+	QStringList solvers = model_.arm().ikSolverNames();
+	solvers.push_front(RobotArm::AutomaticSolver);
+
+	for (const QString& name : solvers) {
+		act = ik_type_->addAction(name);
+		act->setCheckable(true);
+		act->setChecked(name == model_.arm().ikSolver());
+		connect(act, &QAction::triggered, this, [this, name]() { setIKSolver(name); });
+		ik_type_group_->addAction(act);
+	}
+
+	ik_type_->addSeparator();
+	benchmark_action_ = ik_type_->addAction("Benchmark Solvers ...");
+	connect(benchmark_action_, &QAction::triggered, this, &xeroarm::benchmarkIKSolvers);
 
 	window_menu_ = new QMenu(tr("&Windows"));
 	menuBar()->addMenu(window_menu_);
@@ -194,9 +209,45 @@ void xeroarm::createMenus()
 	window_menu_->addSeparator();
 }
 
-void xeroarm::setIKJacobian()
+void xeroarm::setIKSolver(const QString& name)
+{
+	model_.setIKSolver(name);
+	ik_type_text_->setText(name);
+}
+
+void xeroarm::benchmarkIKSolvers()
+{
+	//
+	// The benchmark takes seconds, so run it on a copy of the arm, which can be edited in
+	// the meantime, and report back through benchmarkFinished when it is done
+	//
+	benchmark_action_->setEnabled(false);
+	status_text_->setText("Benchmarking inverse kinematics solvers");
+
+	std::shared_ptr<RobotArm> arm = std::make_shared<RobotArm>(model_.arm());
+	pool_.post([this, arm]() {
+		IKBenchmark benchmark(*arm);
+		QVector<IKBenchmarkResult> results = benchmark.run();
+		QVector<FKBenchmarkResult> fkresults = benchmark.runForwardKinematics();
+
+		if (arm->count() == 0) {
+			emit benchmarkFinished("<p>The arm has no joints to benchmark</p>");
+			return;
+		}
+
+		QString text = "<p>" + QString::number(IKBenchmark::DefaultTargets) + " reachable targets for an arm with " + QString::number(arm->count()) + " joints</p>";
+		text += IKBenchmark::report(results);
+		text += "<p>" + QString::number(IKBenchmark::DefaultConfigurations) + " random joint configurations</p>";
+		text += IKBenchmark::report(fkresults);
+		emit benchmarkFinished(text);
+	});
+}
+
+void xeroarm::showBenchmark(const QString& report)
 {
-	ik_type_text_->setText("Jacobian");
+	benchmark_action_->setEnabled(true);
+	status_text_->setText("Idle");
+	QMessageBox::information(this, "Inverse Kinematics Benchmark", report);
 }
 
 void xeroarm::saveFile()
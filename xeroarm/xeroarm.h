@@ -5,6 +5,7 @@
 #include "PathsDisplayWidget.h"
 #include "WaypointWindow.h"
 #include "PlotWindow.h"
+#include "ThreadPool.h"
 #include <QtWidgets/QMainWindow>
 #include <QtWidgets/QMenu>
 
@@ -17,6 +18,9 @@ public:
     xeroarm(QWidget *parent = nullptr);
     ~xeroarm();
 
+signals:
+    void benchmarkFinished(const QString& report);
+
 protected:
     void closeEvent(QCloseEvent* ev) override;
 
@@ -38,7 +42,9 @@ private:
     void timeChange(double t);
     void mouseMove(const Translation2d& pos);
 
-    void setIKJacobian();
+    void setIKSolver(const QString& name);
+    void benchmarkIKSolvers();
+    void showBenchmark(const QString& report);
 
 private:
     static constexpr const char* GeometrySetting = "geometry";
@@ -71,6 +77,11 @@ private:
     QMenu* window_menu_;
     QMenu* ik_type_;
     QActionGroup* ik_type_group_;
-    QAction* ik_jacobian_;
-    QAction* ik_annealing_;
+    QAction* benchmark_action_;
+
+    //
+    // Runs the solver benchmark away from the UI thread.  Declared last so it is destroyed
+    // first, and a benchmark still running finishes before the window goes away.
+    //
+    ThreadPool pool_;
 };